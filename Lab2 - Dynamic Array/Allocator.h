@@ -0,0 +1,286 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdlib>
+#include <cstring>
+#include <memory_resource>
+#include <new>
+
+#ifdef _WIN32
+#include <malloc.h>
+#else
+#include <sys/mman.h>
+#endif
+
+/* allocators for Array: allocate( bytes ), reallocate( p, old_bytes, new_bytes ),
+   deallocate( p, bytes ); reallocate may be used only for trivially relocatable data */
+
+constexpr std::size_t DEFAULT_ARENA_BLOCK_SIZE = 64 * 1024;
+constexpr std::size_t HUGE_PAGE_SIZE = 2 * 1024 * 1024;
+
+
+/* default, heap via malloc/realloc/free */
+struct MallocAllocator
+{
+	void* allocate( std::size_t bytes )
+	{
+		return std::malloc( bytes );
+	}
+
+	void* reallocate( void* p, std::size_t, std::size_t new_bytes )
+	{
+		return std::realloc( p, new_bytes );
+	}
+
+	void deallocate( void* p, std::size_t )
+	{
+		std::free( p );
+	}
+};
+
+
+/* blocks of at least one huge page are aligned to it and, on Linux, marked
+   for transparent huge pages to cut TLB misses; smaller ones come from malloc */
+struct HugePageAllocator
+{
+	void* allocate( std::size_t bytes )
+	{
+		if ( bytes < HUGE_PAGE_SIZE )
+		{
+			return std::malloc( bytes );
+		}
+		if ( bytes > (std::size_t) -1 - HUGE_PAGE_SIZE )
+		{
+			return nullptr;
+		}
+		std::size_t rounded = ( bytes + HUGE_PAGE_SIZE - 1 ) / HUGE_PAGE_SIZE * HUGE_PAGE_SIZE;
+#ifdef _WIN32
+		return _aligned_malloc( rounded, HUGE_PAGE_SIZE );
+#else
+		void* p = nullptr;
+		if ( posix_memalign( &p, HUGE_PAGE_SIZE, rounded ) != 0 )
+		{
+			return nullptr;
+		}
+#ifdef MADV_HUGEPAGE
+		madvise( p, rounded, MADV_HUGEPAGE );
+#endif
+		return p;
+#endif
+	}
+
+	void* reallocate( void* p, std::size_t old_bytes, std::size_t new_bytes )
+	{
+		if ( old_bytes < HUGE_PAGE_SIZE && new_bytes < HUGE_PAGE_SIZE )
+		{
+			return std::realloc( p, new_bytes );
+		}
+		void* q = allocate( new_bytes );
+		if ( q != nullptr && p != nullptr )
+		{
+			std::memcpy( q, p, old_bytes < new_bytes ? old_bytes : new_bytes );
+			deallocate( p, old_bytes );
+		}
+		return q;
+	}
+
+	void deallocate( void* p, std::size_t bytes )
+	{
+#ifdef _WIN32
+		if ( bytes >= HUGE_PAGE_SIZE )
+		{
+			_aligned_free( p );
+			return;
+		}
+#else
+		(void) bytes;
+#endif
+		std::free( p );
+	}
+};
+
+
+/* monotonic arena: memory is handed out from big blocks and is returned
+   all at once by release() or the destructor */
+class Arena final
+{
+	public:
+		Arena( std::size_t block_size = DEFAULT_ARENA_BLOCK_SIZE );
+		Arena( const Arena& other ) = delete;
+		~Arena();
+
+		Arena& operator = ( const Arena& other ) = delete;
+
+		void* allocate( std::size_t bytes );
+		void* reallocate( void* p, std::size_t old_bytes, std::size_t new_bytes );
+		void deallocate( void* p, std::size_t bytes );
+		void release();
+
+	private:
+		struct Block
+		{
+			Block* next;
+			std::size_t size;
+			std::size_t used;
+		};
+
+		static constexpr std::size_t ALIGNMENT = alignof( std::max_align_t );
+		static constexpr std::size_t HEADER_SIZE = ( sizeof( Block ) + ALIGNMENT - 1 ) / ALIGNMENT * ALIGNMENT;
+
+		std::size_t block_size;
+		Block* head;
+		void* last;
+
+		static std::size_t align( std::size_t bytes );
+		static char* data( Block* block );
+};
+
+
+inline Arena::Arena( std::size_t block_size ):
+	block_size( block_size ),
+	head( nullptr ),
+	last( nullptr )
+{}
+
+
+inline Arena::~Arena()
+{
+	release();
+}
+
+
+inline std::size_t Arena::align( std::size_t bytes )
+{
+	return ( bytes + ALIGNMENT - 1 ) / ALIGNMENT * ALIGNMENT;
+}
+
+
+inline char* Arena::data( Block* block )
+{
+	return reinterpret_cast<char*>( block ) + HEADER_SIZE;
+}
+
+
+inline void* Arena::allocate( std::size_t bytes )
+{
+	bytes = align( bytes > 0 ? bytes : 1 );
+	if ( head == nullptr || head->size - head->used < bytes )
+	{
+		std::size_t size = bytes > block_size ? bytes : block_size;
+		Block* block = (Block*) std::malloc( HEADER_SIZE + size );
+		if ( block == nullptr )
+		{
+			throw std::bad_alloc();
+		}
+		block->next = head;
+		block->size = size;
+		block->used = 0;
+		head = block;
+	}
+	last = data( head ) + head->used;
+	head->used += bytes;
+	return last;
+}
+
+
+/* the most recent allocation grows in place while the block has room */
+inline void* Arena::reallocate( void* p, std::size_t old_bytes, std::size_t new_bytes )
+{
+	if ( p != nullptr && p == last )
+	{
+		std::size_t offset = (char*) p - data( head );
+		if ( offset + align( new_bytes ) <= head->size )
+		{
+			head->used = offset + align( new_bytes );
+			return p;
+		}
+	}
+	void* q = allocate( new_bytes );
+	if ( p != nullptr )
+	{
+		std::memcpy( q, p, old_bytes < new_bytes ? old_bytes : new_bytes );
+	}
+	return q;
+}
+
+
+/* only the most recent allocation is given back */
+inline void Arena::deallocate( void* p, std::size_t )
+{
+	if ( p != nullptr && p == last )
+	{
+		head->used = (char*) p - data( head );
+		last = nullptr;
+	}
+}
+
+
+inline void Arena::release()
+{
+	while ( head != nullptr )
+	{
+		Block* next = head->next;
+		std::free( head );
+		head = next;
+	}
+	last = nullptr;
+}
+
+
+/* array memory from an arena, which must outlive the array */
+struct ArenaAllocator
+{
+	Arena* arena;
+
+	ArenaAllocator( Arena& arena ): arena( &arena ) {}
+
+	void* allocate( std::size_t bytes )
+	{
+		return arena->allocate( bytes );
+	}
+
+	void* reallocate( void* p, std::size_t old_bytes, std::size_t new_bytes )
+	{
+		return arena->reallocate( p, old_bytes, new_bytes );
+	}
+
+	void deallocate( void* p, std::size_t bytes )
+	{
+		arena->deallocate( p, bytes );
+	}
+};
+
+
+/* adapter for std::pmr memory resources (pools, monotonic buffers) */
+struct PmrAllocator
+{
+	std::pmr::memory_resource* resource;
+
+	PmrAllocator( std::pmr::memory_resource* resource = std::pmr::get_default_resource() ):
+		resource( resource )
+	{}
+
+	void* allocate( std::size_t bytes )
+	{
+		return resource->allocate( bytes > 0 ? bytes : 1 );
+	}
+
+	void* reallocate( void* p, std::size_t old_bytes, std::size_t new_bytes )
+	{
+		void* q = allocate( new_bytes );
+		if ( p != nullptr )
+		{
+			std::memcpy( q, p, old_bytes < new_bytes ? old_bytes : new_bytes );
+			deallocate( p, old_bytes );
+		}
+		return q;
+	}
+
+	void deallocate( void* p, std::size_t bytes )
+	{
+		if ( p != nullptr )
+		{
+			resource->deallocate( p, bytes > 0 ? bytes : 1 );
+		}
+	}
+};
\ No newline at end of file
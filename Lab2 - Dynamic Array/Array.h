@@ -1,42 +1,152 @@
 #pragma once
 
+#include <cstdlib>
+#include <cstring>
+#include <limits>
+#include <iterator>
+#include <new>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+
+#include "Allocator.h"
+#include "ArrayStats.h"
+#include "Parallel.h"
+
 /* dynamic array */
 
 constexpr int DEFAULT_ARRAY_CAPACITY = 8;
+/* copies of trivially copyable data from this size on are done by all cores */
+constexpr std::size_t PARALLEL_COPY_BYTES = 16 * 1024 * 1024;
+
+/* ARRAY_INSTRUMENTATION turns on the counters of ArrayStats.h */
+#ifdef ARRAY_INSTRUMENTATION
+#define ARRAY_RECORD( event ) ( statistics.event, global_array_stats.event )
+#else
+#define ARRAY_RECORD( event ) ( (void) 0 )
+#endif
+
 
+/* types whose objects can be moved to another address by plain memory copy
+   (the source is then treated as destroyed); specialize for own types */
 template<typename T>
-class Array final
+struct is_trivially_relocatable : std::is_trivially_copyable<T> {};
+
+
+/* moving count elements to uninitialized memory (ranges may overlap),
+   the source elements are destroyed */
+template<typename T>
+void relocate( T* from, T* to, std::size_t count )
+{
+	if ( to == from || count == 0 )
+	{
+		return;
+	}
+	if constexpr ( is_trivially_relocatable<T>::value )
+	{
+		std::memmove( to, from, count * sizeof( T ) );
+		return;
+	}
+	if ( to > from )
+	{
+		for ( std::size_t i = count; i > 0; i-- )
+		{
+			new( to + i - 1 ) T( std::move( from[i - 1] ) );
+			from[i - 1].~T();
+		}
+	}
+	else
+	{
+		for ( std::size_t i = 0; i < count; i++ )
+		{
+			new( to + i ) T( std::move( from[i] ) );
+			from[i].~T();
+		}
+	}
+}
+
+
+/* storage for the first N elements inside the array object itself */
+template<typename T, std::size_t N>
+class InlineStorage
+{
+	protected:
+		T* inline_data() { return reinterpret_cast<T*>( buffer ); }
+		const T* inline_data() const { return reinterpret_cast<const T*>( buffer ); }
+	private:
+		alignas( T ) unsigned char buffer[N * sizeof( T )];
+};
+
+template<typename T>
+class InlineStorage<T, 0>
+{
+	protected:
+		T* inline_data() { return nullptr; }
+		const T* inline_data() const { return nullptr; }
+};
+
+
+/* N > 0 keeps up to N elements without heap allocation,
+   Allocator provides the heap memory (see Allocator.h) */
+template<typename T, std::size_t N = 0, typename Allocator = MallocAllocator>
+class Array final : private InlineStorage<T, N>
 {
 	public:
 		Array();
-		Array( int capacity );
-		Array( const Array<T>& other );
-		Array( Array<T>&& other );
+		explicit Array( const Allocator& allocator );
+		Array( std::size_t capacity, const Allocator& allocator = Allocator() );
+		Array( const Array& other );
+		Array( const Array& other, const Allocator& allocator );
+		Array( Array&& other );
 		~Array();
 
-		Array<T>& operator = ( const Array<T>& other );
-		Array<T>& operator = ( Array<T>&& other );
+		Array& operator = ( const Array& other );
+		Array& operator = ( Array&& other );
+
+		std::size_t insert( const T& value );
+		std::size_t insert( T&& value );
+		std::size_t insert( std::size_t index, const T& value );
+		std::size_t insert( std::size_t index, T&& value );
+		void remove( std::size_t index );
+
+		/* copying [first, last) to position index, the tail is shifted once */
+		std::size_t insert( std::size_t index, const T* first, const T* last );
+		template<std::size_t M, typename OtherAllocator>
+		std::size_t insert( std::size_t index, const Array<T, M, OtherAllocator>& other );
+		std::size_t append( const T* first, const T* last );
+		template<std::size_t M, typename OtherAllocator>
+		std::size_t append( const Array<T, M, OtherAllocator>& other );
+
+		/* removing [first, last) or every element matching pred in one pass */
+		void erase( std::size_t first, std::size_t last );
+		template<typename Predicate>
+		std::size_t erase_if( Predicate pred );
 
-		int insert( const T& value );
-		int insert( int index, const T& value );
-		void remove( int index );
+		void reserve( std::size_t capacity );
+		void shrink_to_fit();
 
-		const T& operator [] ( int index ) const;
-		T& operator [] ( int index );
-		int length() const;
+		/* constructing a new element in place from args */
+		template<typename... Args>
+		std::size_t emplace_back( Args&&... args );
+		template<typename... Args>
+		std::size_t emplace( std::size_t index, Args&&... args );
+
+		const T& operator [] ( std::size_t index ) const;
+		T& operator [] ( std::size_t index );
+		std::size_t length() const;
 
 
 		class Iterator
 		{
 			public:
-				Iterator( Array<T>* array, int step );
+				Iterator( Array* array, int step );
 				T& get() const;
 				void set( const T& value );
 				void next();
 				bool hasCurrent() const;
 			private:
-				Array<T>* array;
-				int index;
+				Array* array;
+				std::size_t index;
 				int step;
 		};
 
@@ -46,211 +156,584 @@ class Array final
 		class ConstIterator
 		{
 			public:
-				ConstIterator( Array<T>* array, int step );
+				ConstIterator( const Array* array, int step );
 				const T& get() const;
 				void next();
 				bool hasCurrent() const;
 			private:
-				Array<T>* array;
-				int index;
+				const Array* array;
+				std::size_t index;
 				int step;
 		};
 
 		ConstIterator iterator() const;
 		ConstIterator reverseIterator() const;
 
+
+		/* contiguous STL-compatible iterators (plain pointers) */
+		using value_type = T;
+
+		T* data();
+		const T* data() const;
+		T* begin();
+		T* end();
+		const T* begin() const;
+		const T* end() const;
+		std::reverse_iterator<T*> rbegin();
+		std::reverse_iterator<T*> rend();
+		std::reverse_iterator<const T*> rbegin() const;
+		std::reverse_iterator<const T*> rend() const;
+
+#ifdef ARRAY_INSTRUMENTATION
+		/* counters of this array object; on move only live_bytes
+		   goes along with the buffer */
+		const ArrayStats& stats() const;
+#endif
+
 	private:
-		int capacity;
-		int size;
+		std::size_t capacity;
+		std::size_t size;
 		T* a;
-
+		Allocator allocator;
+#ifdef ARRAY_INSTRUMENTATION
+		ArrayStats statistics;
+#endif
+
+		bool is_inline() const;
+		void reset();
+		void steal( Array& other );
 		void clear();
-		void enlarge_capacity( int shift_index );
+		T* allocate( std::size_t capacity );
+		std::size_t grown_capacity( std::size_t required ) const;
+		void enlarge_capacity( std::size_t shift_index );
+		void reallocate( std::size_t new_capacity, std::size_t gap_index, std::size_t gap );
+		void shift( std::size_t from, std::size_t to, std::size_t count );
 };
 
 
 /* default costructor */
-template<typename T>
-Array<T>::Array():
-	capacity( DEFAULT_ARRAY_CAPACITY ),
-	size( 0 )
+template<typename T, std::size_t N, typename Allocator>
+Array<T, N, Allocator>::Array():
+	allocator()
 {
-	a = (T*) std::malloc( capacity * sizeof( T ) );
+	reset();
+}
+
+
+template<typename T, std::size_t N, typename Allocator>
+Array<T, N, Allocator>::Array( const Allocator& allocator ):
+	allocator( allocator )
+{
+	reset();
 }
 
 
 /* with parameter */
-template<typename T>
-Array<T>::Array( int capacity ):
-	capacity( capacity > 0 ? capacity : DEFAULT_ARRAY_CAPACITY ),
-	size( 0 )
+template<typename T, std::size_t N, typename Allocator>
+Array<T, N, Allocator>::Array( std::size_t capacity, const Allocator& allocator ):
+	allocator( allocator )
 {
-	a = (T*) std::malloc( this->capacity * sizeof( T ) );
+	if ( capacity <= N )
+	{
+		reset();
+		return;
+	}
+	this->capacity = capacity;
+	size = 0;
+	a = allocate( capacity );
 }
 
 
-/* copy constructor */
-template<typename T>
-Array<T>::Array( const Array<T>& other ):
-	capacity( other.capacity ),
-	size( other.size )
+/* copy constructor, the copy gets no spare capacity */
+template<typename T, std::size_t N, typename Allocator>
+Array<T, N, Allocator>::Array( const Array<T, N, Allocator>& other ):
+	Array( other, other.allocator )
+{}
+
+
+template<typename T, std::size_t N, typename Allocator>
+Array<T, N, Allocator>::Array( const Array<T, N, Allocator>& other, const Allocator& allocator ):
+	Array( other.size, allocator )
 {
-	a = (T*) std::malloc( capacity * sizeof( T ) );
-	for ( int i = 0; i < size; i++ )
+	ARRAY_RECORD( on_copy( other.size ) );
+	ARRAY_RECORD( on_length( other.size ) );
+	if constexpr ( std::is_trivially_copyable<T>::value )
 	{
-		new( a + i ) T( other[i] );
+		if ( other.size * sizeof( T ) >= PARALLEL_COPY_BYTES )
+		{
+			parallel_copy( other.a, other.a + other.size, a );
+		}
+		else
+		{
+			std::memcpy( a, other.a, other.size * sizeof( T ) );
+		}
+		size = other.size;
+		return;
+	}
+	/* size counts only constructed elements: if a copy throws,
+	   the destructor destroys just those */
+	for ( ; size < other.size; size++ )
+	{
+		new( a + size ) T( other[size] );
 	}
 }
 
 
 /* move constructor */
-template<typename T>
-Array<T>::Array( Array<T>&& other ):
-	capacity( other.capacity ),
-	size( other.size ),
-	a( other.a )
+template<typename T, std::size_t N, typename Allocator>
+Array<T, N, Allocator>::Array( Array<T, N, Allocator>&& other ):
+	allocator( other.allocator )
 {
-	other.a = nullptr;
-	other.size = 0;
-	other.capacity = 0;
+	steal( other );
 }
 
 
 /* destructor */
-template<typename T>
-Array<T>::~Array()
+template<typename T, std::size_t N, typename Allocator>
+Array<T, N, Allocator>::~Array()
 {
 	clear();
 }
 
 
 /* copy assignment */
-template<typename T>
-Array<T>& Array<T>::operator = ( const Array<T>& other )
+template<typename T, std::size_t N, typename Allocator>
+Array<T, N, Allocator>& Array<T, N, Allocator>::operator = ( const Array<T, N, Allocator>& other )
 {
-	Array<T> copy( other );
-	std::swap( capacity, copy.capacity );
-	std::swap( size, copy.size );
-	std::swap( a, copy.a );
+	if ( this != &other )
+	{
+		Array<T, N, Allocator> copy( other, allocator );
+		clear();
+		steal( copy );
+	}
 	return *this;
 }
 
 
 /* move assignment */
-template<typename T>
-Array<T>& Array<T>::operator = ( Array<T>&& other )
+template<typename T, std::size_t N, typename Allocator>
+Array<T, N, Allocator>& Array<T, N, Allocator>::operator = ( Array<T, N, Allocator>&& other )
 {
 	if ( this != &other )
 	{
 		clear();
-		capacity = other.capacity;
-		size = other.size;
-		a = other.a;
+		steal( other );
+	}
+	return *this;
+}
+
+
+template<typename T, std::size_t N, typename Allocator>
+bool Array<T, N, Allocator>::is_inline() const
+{
+	return N > 0 && a == this->inline_data();
+}
+
+
+/* empty array state, without freeing */
+template<typename T, std::size_t N, typename Allocator>
+void Array<T, N, Allocator>::reset()
+{
+	size = 0;
+	if constexpr ( N > 0 )
+	{
+		capacity = N;
+		a = this->inline_data();
+	}
+	else
+	{
+		capacity = DEFAULT_ARRAY_CAPACITY;
+		a = allocate( capacity );
+	}
+}
+
+
+/* taking other's elements together with its allocator, other is left empty */
+template<typename T, std::size_t N, typename Allocator>
+void Array<T, N, Allocator>::steal( Array<T, N, Allocator>& other )
+{
+	size = other.size;
+	allocator = other.allocator;
+	if ( other.is_inline() )
+	{
+		capacity = N;
+		a = this->inline_data();
+		relocate( other.a, a, size );
+		ARRAY_RECORD( on_move( size ) );
+		other.size = 0;
+		return;
+	}
+	capacity = other.capacity;
+	a = other.a;
+#ifdef ARRAY_INSTRUMENTATION
+	statistics.live_bytes += capacity * sizeof( T );
+	other.statistics.live_bytes -= capacity * sizeof( T );
+#endif
+	if constexpr ( N > 0 )
+	{
+		other.reset();
+	}
+	else
+	{
 		other.a = nullptr;
 		other.size = 0;
 		other.capacity = 0;
 	}
-	return *this;
 }
 
 
 /* memory freeing */
-template<typename T>
-void Array<T>::clear()
+template<typename T, std::size_t N, typename Allocator>
+void Array<T, N, Allocator>::clear()
 {
-	for ( int i = 0; i < size; i++ )
+	if constexpr ( !std::is_trivially_destructible<T>::value )
+	{
+		for ( std::size_t i = 0; i < size; i++ )
+		{
+			a[i].~T();
+		}
+	}
+	if ( !is_inline() && a != nullptr )
 	{
-		a[i].~T();
+		ARRAY_RECORD( on_deallocate( capacity * sizeof( T ) ) );
+		allocator.deallocate( a, capacity * sizeof( T ) );
 	}
-	std::free( a );
 }
 
 
-template<typename T>
-int Array<T>::insert( const T& value )
+template<typename T, std::size_t N, typename Allocator>
+std::size_t Array<T, N, Allocator>::insert( const T& value )
+{
+	return emplace_back( value );
+}
+
+
+template<typename T, std::size_t N, typename Allocator>
+std::size_t Array<T, N, Allocator>::insert( T&& value )
+{
+	return emplace_back( std::move( value ) );
+}
+
+
+template<typename T, std::size_t N, typename Allocator>
+std::size_t Array<T, N, Allocator>::insert( std::size_t index, const T& value )
+{
+	return emplace( index, value );
+}
+
+
+template<typename T, std::size_t N, typename Allocator>
+std::size_t Array<T, N, Allocator>::insert( std::size_t index, T&& value )
+{
+	return emplace( index, std::move( value ) );
+}
+
+
+template<typename T, std::size_t N, typename Allocator>
+template<typename... Args>
+std::size_t Array<T, N, Allocator>::emplace_back( Args&&... args )
 {
 	if ( size == capacity )
 	{
 		enlarge_capacity( size );
 	}
-	new( a + size ) T( value );
+	new( a + size ) T( std::forward<Args>( args )... );
+	ARRAY_RECORD( on_length( size + 1 ) );
 	return size++;
 }
 
 
-template<typename T>
-int Array<T>::insert( int index, const T& value )
+template<typename T, std::size_t N, typename Allocator>
+template<typename... Args>
+std::size_t Array<T, N, Allocator>::emplace( std::size_t index, Args&&... args )
 {
+	/* built before the tail moves: a throwing constructor leaves the array
+	   as it was, and args may refer to elements of the array itself */
+	T value( std::forward<Args>( args )... );
 	if ( size == capacity )
 	{
 		enlarge_capacity( index );
 	}
 	else
 	{
-		for ( int i = size; i > index; i-- )
-		{
-			new( a + i ) T( std::move( a[i - 1] ) );
-			a[i - 1].~T();
-		}
+		shift( index, index + 1, size - index );
 	}
-	new( a + index ) T( value );
+	new( a + index ) T( std::move( value ) );
 	size++;
+	ARRAY_RECORD( on_length( size ) );
 	return index;
 }
 
+template<typename T, std::size_t N, typename Allocator>
+T* Array<T, N, Allocator>::allocate( std::size_t capacity )
+{
+	if ( capacity > std::numeric_limits<std::size_t>::max() / sizeof( T ) )
+	{
+		throw std::length_error( "Array capacity is too big" );
+	}
+	T* memory = (T*) allocator.allocate( capacity * sizeof( T ) );
+	if ( memory == nullptr )
+	{
+		throw std::bad_alloc();
+	}
+	ARRAY_RECORD( on_allocate( capacity * sizeof( T ) ) );
+	return memory;
+}
+
+
+/* doubled capacity, but at least required; doubling stops at the largest
+   capacity whose size in bytes fits std::size_t */
+template<typename T, std::size_t N, typename Allocator>
+std::size_t Array<T, N, Allocator>::grown_capacity( std::size_t required ) const
+{
+	const std::size_t max_capacity = std::numeric_limits<std::size_t>::max() / sizeof( T );
+	if ( required > max_capacity || required < size )
+	{
+		throw std::length_error( "Array capacity is too big" );
+	}
+	std::size_t doubled = capacity > max_capacity / 2 ? max_capacity : capacity * 2;
+	doubled = doubled > 0 ? doubled : DEFAULT_ARRAY_CAPACITY;
+	return doubled > required ? doubled : required;
+}
+
+
 /* increasing capacity with 1 element shift starting from shift_index */
-template<typename T>
-void Array<T>::enlarge_capacity( int shift_index )
+template<typename T, std::size_t N, typename Allocator>
+void Array<T, N, Allocator>::enlarge_capacity( std::size_t shift_index )
 {
-	capacity *= 2;
-	T* a_enlarged = (T*) std::malloc( capacity * sizeof( T ) );
-	int i = 0;
-	while ( i < shift_index )
+	reallocate( grown_capacity( size + 1 ), shift_index, 1 );
+}
+
+
+/* moving elements to a new buffer of new_capacity (inline if it fits),
+   leaving gap uninitialized slots at gap_index */
+template<typename T, std::size_t N, typename Allocator>
+void Array<T, N, Allocator>::reallocate( std::size_t new_capacity, std::size_t gap_index, std::size_t gap )
+{
+	T* a_new = nullptr;
+	if constexpr ( N > 0 )
 	{
-		new( a_enlarged + i ) T( std::move( a[i] ) );
-		a[i].~T();
-		i++;
+		if ( new_capacity <= N )
+		{
+			new_capacity = N;
+			a_new = this->inline_data();
+		}
+	}
+	if ( a_new == nullptr )
+	{
+		if constexpr ( is_trivially_relocatable<T>::value )
+		{
+			if ( !is_inline() )
+			{
+				if ( new_capacity > std::numeric_limits<std::size_t>::max() / sizeof( T ) )
+				{
+					throw std::length_error( "Array capacity is too big" );
+				}
+				T* a_resized = (T*) allocator.reallocate( a, capacity * sizeof( T ), new_capacity * sizeof( T ) );
+				if ( a_resized == nullptr )
+				{
+					throw std::bad_alloc();
+				}
+				ARRAY_RECORD( on_reallocate() );
+				ARRAY_RECORD( on_resize( capacity * sizeof( T ), new_capacity * sizeof( T ) ) );
+				a = a_resized;
+				capacity = new_capacity;
+				shift( gap_index, gap_index + gap, size - gap_index );
+				return;
+			}
+		}
+		a_new = allocate( new_capacity );
 	}
-	while ( i < size )
+	relocate( a, a_new, gap_index );
+	relocate( a + gap_index, a_new + gap_index + gap, size - gap_index );
+	ARRAY_RECORD( on_reallocate() );
+	ARRAY_RECORD( on_move( size ) );
+	if ( !is_inline() )
 	{
-		new( a_enlarged + i + 1 ) T( std::move( a[i] ) );
-		a[i].~T();
-		i++;
+		ARRAY_RECORD( on_deallocate( capacity * sizeof( T ) ) );
+		allocator.deallocate( a, capacity * sizeof( T ) );
 	}
-	std::free( a );
-	a = a_enlarged;
+	a = a_new;
+	capacity = new_capacity;
 }
 
 
-template<typename T>
-void Array<T>::remove( int index )
+template<typename T, std::size_t N, typename Allocator>
+void Array<T, N, Allocator>::reserve( std::size_t capacity )
 {
-	a[index].~T();
-	for ( int i = index + 1; i < size; i++ )
+	if ( capacity > this->capacity )
+	{
+		reallocate( capacity, size, 0 );
+	}
+}
+
+
+/* releasing unused capacity, moving back to inline storage if possible */
+template<typename T, std::size_t N, typename Allocator>
+void Array<T, N, Allocator>::shrink_to_fit()
+{
+	if ( is_inline() || size == capacity )
+	{
+		return;
+	}
+	reallocate( size > 0 ? size : 1, size, 0 );
+}
+
+
+/* relocating count elements from index from to index to */
+template<typename T, std::size_t N, typename Allocator>
+void Array<T, N, Allocator>::shift( std::size_t from, std::size_t to, std::size_t count )
+{
+	if ( count > 0 )
+	{
+		ARRAY_RECORD( on_shift( count ) );
+	}
+	relocate( a + from, a + to, count );
+}
+
+
+template<typename T, std::size_t N, typename Allocator>
+std::size_t Array<T, N, Allocator>::insert( std::size_t index, const T* first, const T* last )
+{
+	if ( last <= first )
+	{
+		return index;
+	}
+	std::size_t count = (std::size_t) ( last - first );
+	if ( first >= a && first < a + size )
+	{
+		/* source is inside this array and would be moved by the shift */
+		Array<T> copy( count );
+		copy.append( first, last );
+		return insert( index, copy );
+	}
+	if ( size + count > capacity || size + count < size )
+	{
+		reallocate( grown_capacity( size + count ), index, count );
+	}
+	else
 	{
-		new ( a + i - 1 ) T( std::move( a[i] ) );
-		a[i].~T();
+		shift( index, index + count, size - index );
+	}
+	if constexpr ( std::is_trivially_copyable<T>::value )
+	{
+		std::memcpy( a + index, first, count * sizeof( T ) );
+	}
+	else
+	{
+		for ( std::size_t i = 0; i < count; i++ )
+		{
+			new( a + index + i ) T( first[i] );
+		}
 	}
+	size += count;
+	ARRAY_RECORD( on_copy( count ) );
+	ARRAY_RECORD( on_length( size ) );
+	return index;
+}
+
+
+template<typename T, std::size_t N, typename Allocator>
+template<std::size_t M, typename OtherAllocator>
+std::size_t Array<T, N, Allocator>::insert( std::size_t index, const Array<T, M, OtherAllocator>& other )
+{
+	if ( other.length() == 0 )
+	{
+		return index;
+	}
+	return insert( index, &other[0], &other[0] + other.length() );
+}
+
+
+template<typename T, std::size_t N, typename Allocator>
+std::size_t Array<T, N, Allocator>::append( const T* first, const T* last )
+{
+	return insert( size, first, last );
+}
+
+
+template<typename T, std::size_t N, typename Allocator>
+template<std::size_t M, typename OtherAllocator>
+std::size_t Array<T, N, Allocator>::append( const Array<T, M, OtherAllocator>& other )
+{
+	return insert( size, other );
+}
+
+
+template<typename T, std::size_t N, typename Allocator>
+void Array<T, N, Allocator>::remove( std::size_t index )
+{
+	a[index].~T();
+	shift( index + 1, index, size - index - 1 );
 	size--;
 }
 
 
-template<typename T>
-const T& Array<T>::operator [] ( int index ) const
+template<typename T, std::size_t N, typename Allocator>
+void Array<T, N, Allocator>::erase( std::size_t first, std::size_t last )
+{
+	if ( first >= last )
+	{
+		return;
+	}
+	if constexpr ( !std::is_trivially_destructible<T>::value )
+	{
+		for ( std::size_t i = first; i < last; i++ )
+		{
+			a[i].~T();
+		}
+	}
+	shift( last, first, size - last );
+	size -= last - first;
+}
+
+
+/* survivors are relocated by runs, pred is called once per element,
+   returns the number of removed elements */
+template<typename T, std::size_t N, typename Allocator>
+template<typename Predicate>
+std::size_t Array<T, N, Allocator>::erase_if( Predicate pred )
+{
+	std::size_t w = 0;
+	std::size_t r = 0;
+	while ( r < size )
+	{
+		std::size_t run = r;
+		while ( run < size && !pred( a[run] ) )
+		{
+			run++;
+		}
+		relocate( a + r, a + w, run - r );
+		ARRAY_RECORD( on_move( w < r ? run - r : 0 ) );
+		w += run - r;
+		if ( run < size )
+		{
+			a[run].~T();
+		}
+		r = run + 1;
+	}
+	std::size_t removed = size - w;
+	size = w;
+	return removed;
+}
+
+
+template<typename T, std::size_t N, typename Allocator>
+const T& Array<T, N, Allocator>::operator [] ( std::size_t index ) const
 {
 	return a[index];
 }
 
 
-template<typename T>
-T& Array<T>::operator [] ( int index )
+template<typename T, std::size_t N, typename Allocator>
+T& Array<T, N, Allocator>::operator [] ( std::size_t index )
 {
 	return a[index];
 }
 
 
-template<typename T>
-int Array<T>::length() const
+template<typename T, std::size_t N, typename Allocator>
+std::size_t Array<T, N, Allocator>::length() const
 {
 	return size;
 }
@@ -260,89 +743,162 @@ int Array<T>::length() const
 /* iterators */
 
 
-template<typename T>
-Array<T>::Iterator::Iterator( Array<T>* array, int step ):
+template<typename T, std::size_t N, typename Allocator>
+Array<T, N, Allocator>::Iterator::Iterator( Array<T, N, Allocator>* array, int step ):
 	array( array ),
-	step( step ),
-	index( step > 0 ? 0 : ( array->length() - 1 ) )
+	index( step > 0 ? 0 : ( array->length() - 1 ) ),
+	step( step )
 {}
 
-template<typename T>
-void Array<T>::Iterator::next()
+template<typename T, std::size_t N, typename Allocator>
+void Array<T, N, Allocator>::Iterator::next()
 {
 	index += step;
 }
 
-template<typename T>
-bool Array<T>::Iterator::hasCurrent() const
+template<typename T, std::size_t N, typename Allocator>
+bool Array<T, N, Allocator>::Iterator::hasCurrent() const
 {
-	return ( index >= 0 ) && ( index < array->length() );
+	/* stepping below 0 wraps around to a huge index */
+	return index < array->length();
 }
 
-template<typename T>
-T& Array<T>::Iterator::get() const
+template<typename T, std::size_t N, typename Allocator>
+T& Array<T, N, Allocator>::Iterator::get() const
 {
 	return ( *array )[index];
 }
 
-template<typename T>
-void Array<T>::Iterator::set( const T& value )
+template<typename T, std::size_t N, typename Allocator>
+void Array<T, N, Allocator>::Iterator::set( const T& value )
 {
 	( *array )[index] = value;
 }
 
 
-template<typename T>
-Array<T>::ConstIterator::ConstIterator( Array<T>* array, int step ):
+template<typename T, std::size_t N, typename Allocator>
+Array<T, N, Allocator>::ConstIterator::ConstIterator( const Array<T, N, Allocator>* array, int step ):
 	array( array ),
-	step( step ),
-	index( step > 0 ? 0 : ( array->length() - 1 ) )
+	index( step > 0 ? 0 : ( array->length() - 1 ) ),
+	step( step )
 {}
 
-template<typename T>
-void Array<T>::ConstIterator::next()
+template<typename T, std::size_t N, typename Allocator>
+void Array<T, N, Allocator>::ConstIterator::next()
 {
 	index += step;
 }
 
-template<typename T>
-bool Array<T>::ConstIterator::hasCurrent() const
+template<typename T, std::size_t N, typename Allocator>
+bool Array<T, N, Allocator>::ConstIterator::hasCurrent() const
 {
-	return ( index >= 0 ) && ( index < array->length() );
+	/* stepping below 0 wraps around to a huge index */
+	return index < array->length();
 }
 
-template<typename T>
-const T& Array<T>::ConstIterator::get() const
+template<typename T, std::size_t N, typename Allocator>
+const T& Array<T, N, Allocator>::ConstIterator::get() const
 {
 	return ( *array )[index];
 }
 
 
 
-template<typename T>
-typename Array<T>::Iterator Array<T>::iterator()
+template<typename T, std::size_t N, typename Allocator>
+typename Array<T, N, Allocator>::Iterator Array<T, N, Allocator>::iterator()
 {
-	Array<T>::Iterator iterator( this, 1 );
+	Array<T, N, Allocator>::Iterator iterator( this, 1 );
 	return iterator;
 }
 
-template<typename T>
-typename Array<T>::ConstIterator Array<T>::iterator() const
+template<typename T, std::size_t N, typename Allocator>
+typename Array<T, N, Allocator>::ConstIterator Array<T, N, Allocator>::iterator() const
 {
-	Array<T>::ConstIterator iterator( this, 1 );
+	Array<T, N, Allocator>::ConstIterator iterator( this, 1 );
 	return iterator;
 }
 
-template<typename T>
-typename Array<T>::Iterator Array<T>::reverseIterator()
+template<typename T, std::size_t N, typename Allocator>
+typename Array<T, N, Allocator>::Iterator Array<T, N, Allocator>::reverseIterator()
 {
-	Array<T>::Iterator iterator( this, -1 );
+	Array<T, N, Allocator>::Iterator iterator( this, -1 );
 	return iterator;
 }
 
-template<typename T>
-typename Array<T>::ConstIterator Array<T>::reverseIterator() const
+template<typename T, std::size_t N, typename Allocator>
+typename Array<T, N, Allocator>::ConstIterator Array<T, N, Allocator>::reverseIterator() const
 {
-	Array<T>::ConstIterator iterator( this, -1 );
+	Array<T, N, Allocator>::ConstIterator iterator( this, -1 );
 	return iterator;
-}
\ No newline at end of file
+}
+
+
+
+template<typename T, std::size_t N, typename Allocator>
+T* Array<T, N, Allocator>::data()
+{
+	return a;
+}
+
+template<typename T, std::size_t N, typename Allocator>
+const T* Array<T, N, Allocator>::data() const
+{
+	return a;
+}
+
+template<typename T, std::size_t N, typename Allocator>
+T* Array<T, N, Allocator>::begin()
+{
+	return a;
+}
+
+template<typename T, std::size_t N, typename Allocator>
+T* Array<T, N, Allocator>::end()
+{
+	return a + size;
+}
+
+template<typename T, std::size_t N, typename Allocator>
+const T* Array<T, N, Allocator>::begin() const
+{
+	return a;
+}
+
+template<typename T, std::size_t N, typename Allocator>
+const T* Array<T, N, Allocator>::end() const
+{
+	return a + size;
+}
+
+template<typename T, std::size_t N, typename Allocator>
+std::reverse_iterator<T*> Array<T, N, Allocator>::rbegin()
+{
+	return std::reverse_iterator<T*>( end() );
+}
+
+template<typename T, std::size_t N, typename Allocator>
+std::reverse_iterator<T*> Array<T, N, Allocator>::rend()
+{
+	return std::reverse_iterator<T*>( begin() );
+}
+
+template<typename T, std::size_t N, typename Allocator>
+std::reverse_iterator<const T*> Array<T, N, Allocator>::rbegin() const
+{
+	return std::reverse_iterator<const T*>( end() );
+}
+
+template<typename T, std::size_t N, typename Allocator>
+std::reverse_iterator<const T*> Array<T, N, Allocator>::rend() const
+{
+	return std::reverse_iterator<const T*>( begin() );
+}
+
+
+#ifdef ARRAY_INSTRUMENTATION
+template<typename T, std::size_t N, typename Allocator>
+const ArrayStats& Array<T, N, Allocator>::stats() const
+{
+	return statistics;
+}
+#endif
\ No newline at end of file
@@ -0,0 +1,149 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <ostream>
+
+/* counters of Array memory traffic, collected only when the code is compiled
+   with ARRAY_INSTRUMENTATION defined: every array keeps its own counters
+   (Array::stats()) and adds the same events to the global ones (array_stats()) */
+
+inline void raise_to( std::size_t& counter, std::size_t value )
+{
+	counter = counter < value ? value : counter;
+}
+
+inline void raise_to( std::atomic<std::size_t>& counter, std::size_t value )
+{
+	std::size_t current = counter.load();
+	while ( current < value && !counter.compare_exchange_weak( current, value ) )
+	{}
+}
+
+
+template<typename Counter>
+struct BasicArrayStats
+{
+	Counter allocations{};      /* blocks taken from the allocator */
+	Counter reallocations{};    /* capacity changes: growth, reserve, shrink */
+	Counter deallocations{};
+	Counter allocated_bytes{};  /* total bytes requested from the allocator */
+	Counter live_bytes{};       /* bytes held now */
+	Counter peak_bytes{};       /* the most bytes held at once */
+	Counter copied_elements{};  /* elements copy-constructed from other arrays or ranges */
+	Counter moved_elements{};   /* elements relocated, including the shifts */
+	Counter shifts{};           /* tail shifts by insert / remove / erase */
+	Counter shifted_elements{}; /* elements moved by those shifts */
+	Counter longest_shift{};
+	Counter peak_length{};
+
+	void on_allocate( std::size_t bytes )
+	{
+		allocations += 1;
+		allocated_bytes += bytes;
+		std::size_t live = ( live_bytes += bytes );
+		raise_to( peak_bytes, live );
+	}
+
+	void on_resize( std::size_t old_bytes, std::size_t new_bytes )
+	{
+		allocated_bytes += new_bytes;
+		live_bytes -= old_bytes;
+		std::size_t live = ( live_bytes += new_bytes );
+		raise_to( peak_bytes, live );
+	}
+
+	void on_deallocate( std::size_t bytes )
+	{
+		deallocations += 1;
+		live_bytes -= bytes;
+	}
+
+	void on_reallocate()
+	{
+		reallocations += 1;
+	}
+
+	void on_copy( std::size_t count )
+	{
+		copied_elements += count;
+	}
+
+	void on_move( std::size_t count )
+	{
+		moved_elements += count;
+	}
+
+	void on_shift( std::size_t count )
+	{
+		shifts += 1;
+		shifted_elements += count;
+		moved_elements += count;
+		raise_to( longest_shift, count );
+	}
+
+	void on_length( std::size_t length )
+	{
+		raise_to( peak_length, length );
+	}
+};
+
+
+using ArrayStats = BasicArrayStats<std::size_t>;
+
+/* shared by all arrays of all threads */
+inline BasicArrayStats<std::atomic<std::size_t>> global_array_stats;
+
+
+/* snapshot of the global counters */
+inline ArrayStats array_stats()
+{
+	const auto& g = global_array_stats;
+	ArrayStats s;
+	s.allocations = g.allocations.load();
+	s.reallocations = g.reallocations.load();
+	s.deallocations = g.deallocations.load();
+	s.allocated_bytes = g.allocated_bytes.load();
+	s.live_bytes = g.live_bytes.load();
+	s.peak_bytes = g.peak_bytes.load();
+	s.copied_elements = g.copied_elements.load();
+	s.moved_elements = g.moved_elements.load();
+	s.shifts = g.shifts.load();
+	s.shifted_elements = g.shifted_elements.load();
+	s.longest_shift = g.longest_shift.load();
+	s.peak_length = g.peak_length.load();
+	return s;
+}
+
+
+/* zeroing the global counters; call it while no array holds memory,
+   otherwise live_bytes underflows when those arrays are freed */
+inline void reset_array_stats()
+{
+	auto& g = global_array_stats;
+	for ( std::atomic<std::size_t>* counter : { &g.allocations, &g.reallocations, &g.deallocations,
+		&g.allocated_bytes, &g.live_bytes, &g.peak_bytes, &g.copied_elements, &g.moved_elements,
+		&g.shifts, &g.shifted_elements, &g.longest_shift, &g.peak_length } )
+	{
+		counter->store( 0 );
+	}
+}
+
+
+/* one "name value" line per counter */
+inline std::ostream& operator << ( std::ostream& out, const ArrayStats& s )
+{
+	out << "allocations " << s.allocations << '\n';
+	out << "reallocations " << s.reallocations << '\n';
+	out << "deallocations " << s.deallocations << '\n';
+	out << "allocated bytes " << s.allocated_bytes << '\n';
+	out << "live bytes " << s.live_bytes << '\n';
+	out << "peak bytes " << s.peak_bytes << '\n';
+	out << "copied elements " << s.copied_elements << '\n';
+	out << "moved elements " << s.moved_elements << '\n';
+	out << "shifts " << s.shifts << '\n';
+	out << "shifted elements " << s.shifted_elements << '\n';
+	out << "longest shift " << s.longest_shift << '\n';
+	out << "peak length " << s.peak_length << '\n';
+	return out;
+}
@@ -0,0 +1,389 @@
+#include <iostream>
+#include <fstream>
+#include <map>
+#include <sstream>
+#include <string>
+#include <random>
+#include <ratio>
+#include <chrono>
+#include <thread>
+#include <vector>
+
+#include "../Array.h"
+#include "../ConcurrentArray.h"
+#include "../GapArray.h"
+#include "../TieredArray.h"
+
+
+constexpr int EDIT_COUNT = 2000;
+constexpr int CURSOR_STEP = 16;
+constexpr int CONCURRENT_INSERT_COUNT = 4000000;
+
+constexpr int PUSH_COUNT = 200000;
+constexpr int MIDDLE_BASE_COUNT = 20000;
+constexpr int MIDDLE_EDIT_COUNT = 2000;
+constexpr int MOVE_COUNT = 10000;
+constexpr int REPETITION_COUNT = 10;
+constexpr double REGRESSION_THRESHOLD = 0.15;
+
+/* Array<T> against std::vector<T> */
+
+struct LargePod
+{
+    double v[16];
+};
+
+volatile double sink;
+
+void make_value( int i, int& value ) { value = i; }
+void make_value( int i, std::string& value ) { value = "benchmark string value " + std::to_string( i ); }
+void make_value( int i, LargePod& value ) { value.v[0] = i; }
+
+double weight( int value ) { return value; }
+double weight( const std::string& value ) { return (double) value.size(); }
+double weight( const LargePod& value ) { return value.v[0]; }
+
+/* the best of REPETITION_COUNT runs, seconds */
+template<typename Function>
+double best_time( Function f )
+{
+    using namespace std::chrono;
+
+    double best = 0.0;
+    for ( int r = 0; r < REPETITION_COUNT; r++ )
+    {
+        steady_clock::time_point t1 = steady_clock::now();
+        f();
+        steady_clock::time_point t2 = steady_clock::now();
+        double span = duration_cast<duration<double>>( t2 - t1 ).count();
+        best = ( r == 0 || span < best ) ? span : best;
+    }
+    return best;
+}
+
+void write_row( std::ofstream& file, const char* name, const char* type, double array_time, double vector_time )
+{
+    file << name << ';' << type << ';' << array_time << ';' << vector_time << ';' << array_time / vector_time << ';';
+    file << '\n';
+}
+
+template<typename T>
+void array_benchmark( std::ofstream& file, const char* type )
+{
+    T values[MIDDLE_EDIT_COUNT];
+    for ( int i = 0; i < MIDDLE_EDIT_COUNT; i++ )
+        make_value( i, values[i] );
+
+    double array_time = best_time( [&]()
+    {
+        Array<T> a;
+        for ( int i = 0; i < PUSH_COUNT; i++ )
+            a.insert( values[i % MIDDLE_EDIT_COUNT] );
+        sink = a.length();
+    } );
+    double vector_time = best_time( [&]()
+    {
+        std::vector<T> v;
+        for ( int i = 0; i < PUSH_COUNT; i++ )
+            v.push_back( values[i % MIDDLE_EDIT_COUNT] );
+        sink = (double) v.size();
+    } );
+    write_row( file, "push back", type, array_time, vector_time );
+
+    Array<T> a;
+    std::vector<T> v;
+    for ( int i = 0; i < MIDDLE_BASE_COUNT; i++ )
+    {
+        a.insert( values[i % MIDDLE_EDIT_COUNT] );
+        v.push_back( values[i % MIDDLE_EDIT_COUNT] );
+    }
+
+    array_time = best_time( [&]()
+    {
+        for ( int i = 0; i < MIDDLE_EDIT_COUNT; i++ )
+            a.insert( a.length() / 2, values[i] );
+        for ( int i = 0; i < MIDDLE_EDIT_COUNT; i++ )
+            a.remove( a.length() / 2 );
+    } );
+    vector_time = best_time( [&]()
+    {
+        for ( int i = 0; i < MIDDLE_EDIT_COUNT; i++ )
+            v.insert( v.begin() + v.size() / 2, values[i] );
+        for ( int i = 0; i < MIDDLE_EDIT_COUNT; i++ )
+            v.erase( v.begin() + v.size() / 2 );
+    } );
+    write_row( file, "middle insert remove", type, array_time, vector_time );
+
+    for ( int i = MIDDLE_BASE_COUNT; i < PUSH_COUNT; i++ )
+    {
+        a.insert( values[i % MIDDLE_EDIT_COUNT] );
+        v.push_back( values[i % MIDDLE_EDIT_COUNT] );
+    }
+    const Array<T>& c = a;
+
+    vector_time = best_time( [&]()
+    {
+        double sum = 0.0;
+        for ( std::size_t i = 0; i < v.size(); i++ )
+            sum += weight( v[i] );
+        sink = sum;
+    } );
+    array_time = best_time( [&]()
+    {
+        double sum = 0.0;
+        for ( std::size_t i = 0; i < a.length(); i++ )
+            sum += weight( a[i] );
+        sink = sum;
+    } );
+    write_row( file, "iterate index", type, array_time, vector_time );
+    array_time = best_time( [&]()
+    {
+        double sum = 0.0;
+        for ( auto it = a.iterator(); it.hasCurrent(); it.next() )
+            sum += weight( it.get() );
+        sink = sum;
+    } );
+    write_row( file, "iterate Iterator", type, array_time, vector_time );
+    array_time = best_time( [&]()
+    {
+        double sum = 0.0;
+        for ( auto it = c.iterator(); it.hasCurrent(); it.next() )
+            sum += weight( it.get() );
+        sink = sum;
+    } );
+    write_row( file, "iterate ConstIterator", type, array_time, vector_time );
+    array_time = best_time( [&]()
+    {
+        double sum = 0.0;
+        for ( const T& x : c )
+            sum += weight( x );
+        sink = sum;
+    } );
+    write_row( file, "iterate range for", type, array_time, vector_time );
+
+    array_time = best_time( [&]()
+    {
+        Array<T> copy;
+        copy = a;
+        sink = weight( copy[copy.length() / 2] );
+    } );
+    vector_time = best_time( [&]()
+    {
+        std::vector<T> copy;
+        copy = v;
+        sink = weight( copy[copy.size() / 2] );
+    } );
+    write_row( file, "copy assignment", type, array_time, vector_time );
+
+    array_time = best_time( [&]()
+    {
+        Array<T> moved;
+        for ( int i = 0; i < MOVE_COUNT; i++ )
+        {
+            moved = std::move( a );
+            a = std::move( moved );
+        }
+        sink = a.length();
+    } );
+    vector_time = best_time( [&]()
+    {
+        std::vector<T> moved;
+        for ( int i = 0; i < MOVE_COUNT; i++ )
+        {
+            moved = std::move( v );
+            v = std::move( moved );
+        }
+        sink = (double) v.size();
+    } );
+    write_row( file, "move assignment", type, array_time, vector_time );
+}
+
+void array_benchmark( const char* path )
+{
+    std::ofstream file;
+    file.open( path, std::ofstream::out | std::ofstream::trunc );
+    file << "case;type;array;vector;ratio;";
+    file << '\n';
+    array_benchmark<int>( file, "int" );
+    array_benchmark<std::string>( file, "string" );
+    array_benchmark<LargePod>( file, "large pod" );
+    file.close();
+}
+
+/* array to vector time ratio per case;type key */
+std::map<std::string, double> read_ratios( const char* path )
+{
+    std::map<std::string, double> ratios;
+    std::ifstream file( path );
+    std::string line;
+    std::getline( file, line );
+    while ( std::getline( file, line ) )
+    {
+        std::stringstream row( line );
+        std::string name, type, array_time, vector_time, ratio;
+        std::getline( row, name, ';' );
+        std::getline( row, type, ';' );
+        std::getline( row, array_time, ';' );
+        std::getline( row, vector_time, ';' );
+        std::getline( row, ratio, ';' );
+        if ( !ratio.empty() )
+            ratios[name + ';' + type] = std::stod( ratio );
+    }
+    return ratios;
+}
+
+/* cases whose ratio to std::vector grew by more than REGRESSION_THRESHOLD,
+   the ratio makes results of different machines and runs comparable */
+int compare_with_baseline( const std::map<std::string, double>& baseline, const char* baseline_path, const char* path )
+{
+    std::map<std::string, double> current = read_ratios( path );
+    int regressions = 0;
+    for ( const auto& row : current )
+    {
+        auto old = baseline.find( row.first );
+        if ( old == baseline.end() )
+            continue;
+        if ( row.second > old->second * ( 1.0 + REGRESSION_THRESHOLD ) )
+        {
+            std::cout << "REGRESSION " << row.first << ": " << old->second << " -> " << row.second << std::endl;
+            regressions++;
+        }
+    }
+    std::cout << regressions << " regression(s) against " << baseline_path << std::endl;
+    return regressions;
+}
+
+
+/* positions of the edits: near the previous one or anywhere */
+void edit_positions( int* positions, int length, bool clustered )
+{
+    std::default_random_engine RandomEngine( 42 );
+    std::uniform_int_distribution<int> RandomStepGenerator( -CURSOR_STEP, CURSOR_STEP );
+    int cursor = length / 2;
+    for ( int i = 0; i < EDIT_COUNT; i++ )
+    {
+        if ( clustered )
+        {
+            cursor += RandomStepGenerator( RandomEngine );
+        }
+        else
+        {
+            cursor = std::uniform_int_distribution<int>( 0, length - 1 )( RandomEngine );
+        }
+        cursor = cursor < 0 ? 0 : ( cursor >= length ? length - 1 : cursor );
+        positions[i] = cursor;
+    }
+}
+
+/* alternating insert and remove at the given positions, seconds */
+template<typename Container>
+double edit_time( int length, const int* positions )
+{
+    using namespace std::chrono;
+
+    Container a( length + 1 );
+    for ( int i = 0; i < length; i++ )
+        a.insert( i );
+
+    steady_clock::time_point t1 = steady_clock::now();
+    for ( int i = 0; i < EDIT_COUNT; i++ )
+    {
+        if ( i % 2 == 0 )
+            a.insert( positions[i], i );
+        else
+            a.remove( positions[i] );
+    }
+    steady_clock::time_point t2 = steady_clock::now();
+    return duration_cast<duration<double>>( t2 - t1 ).count();
+}
+
+void gap_benchmark()
+{
+    int positions[EDIT_COUNT];
+
+    std::ofstream file;
+    file.open( "gap_benchmark.csv", std::ofstream::out | std::ofstream::trunc );
+    file << "count;edits;array clustered;gap clustered;tiered clustered;array random;gap random;tiered random;";
+    file << '\n';
+
+    for ( int length = 1000; length <= 1000000; length *= 10 )
+    {
+        file << length << ';' << EDIT_COUNT << ';';
+        for ( bool clustered : { true, false } )
+        {
+            edit_positions( positions, length, clustered );
+            file << edit_time<Array<int>>( length, positions ) << ';';
+            file << edit_time<GapArray<int>>( length, positions ) << ';';
+            file << edit_time<TieredArray<int>>( length, positions ) << ';';
+        }
+        file << '\n';
+    }
+    file.close();
+}
+
+
+/* the same number of elements appended by 1..hardware threads */
+void concurrent_benchmark()
+{
+    using namespace std::chrono;
+
+    std::ofstream file;
+    file.open( "concurrent_benchmark.csv", std::ofstream::out | std::ofstream::trunc );
+    file << "threads;count;time;";
+    file << '\n';
+
+    int max_threads = (int) std::thread::hardware_concurrency();
+    max_threads = max_threads > 0 ? max_threads : 1;
+    for ( int threads = 1; threads <= max_threads; threads++ )
+    {
+        ConcurrentArray<int> a;
+        int per_thread = CONCURRENT_INSERT_COUNT / threads;
+
+        steady_clock::time_point t1 = steady_clock::now();
+        std::vector<std::thread> writers;
+        for ( int t = 0; t < threads; t++ )
+            writers.emplace_back( [&a, per_thread]()
+            {
+                for ( int i = 0; i < per_thread; i++ )
+                    a.insert( i );
+            } );
+        for ( auto& writer : writers )
+            writer.join();
+        steady_clock::time_point t2 = steady_clock::now();
+
+        file << threads << ';' << a.length() << ';' << duration_cast<duration<double>>( t2 - t1 ).count() << ';';
+        file << '\n';
+    }
+    file.close();
+}
+
+
+/* Benchmark                - all benchmarks
+   Benchmark baseline.csv   - Array against std::vector only, compared to
+                              array_benchmark.csv of an earlier commit,
+                              nonzero exit code on regressions */
+int main( int argc, char* argv[] )
+{
+    /* read before array_benchmark.csv is rewritten, which may be the baseline itself */
+    std::map<std::string, double> baseline;
+    if ( argc > 1 )
+    {
+        baseline = read_ratios( argv[1] );
+        if ( baseline.empty() )
+        {
+            std::cout << "no benchmark rows in " << argv[1] << std::endl;
+            return 2;
+        }
+    }
+    array_benchmark( "array_benchmark.csv" );
+    std::cout << "array_benchmark.csv written" << std::endl;
+    if ( argc > 1 )
+    {
+        return compare_with_baseline( baseline, argv[1], "array_benchmark.csv" ) > 0 ? 1 : 0;
+    }
+    gap_benchmark();
+    std::cout << "gap_benchmark.csv written" << std::endl;
+    concurrent_benchmark();
+    std::cout << "concurrent_benchmark.csv written" << std::endl;
+    return 0;
+}
\ No newline at end of file
@@ -0,0 +1,341 @@
+#pragma once
+
+#include <atomic>
+#include <cstdlib>
+#include <new>
+#include <stdexcept>
+#include <utility>
+
+/* append-only array for many writer threads: a slot index is reserved with
+   one atomic increment, segments of doubling length are installed with CAS
+   and never move, readers see the published prefix of constructed elements;
+   the slot of an insert whose constructor threw stays in the prefix as an
+   empty hole that has() reports and the iterators skip */
+
+constexpr std::size_t CONCURRENT_FIRST_SEGMENT_LENGTH = 32;
+constexpr int CONCURRENT_SEGMENT_COUNT = 26;
+
+template<typename T>
+class ConcurrentArray final
+{
+	public:
+		ConcurrentArray();
+		ConcurrentArray( const ConcurrentArray& other ) = delete;
+		~ConcurrentArray();
+
+		ConcurrentArray& operator = ( const ConcurrentArray& other ) = delete;
+
+		/* thread-safe, return the index of the new element;
+		   std::length_error when all segments are used up */
+		std::size_t insert( const T& value );
+		std::size_t insert( T&& value );
+		template<typename... Args>
+		std::size_t emplace_back( Args&&... args );
+
+		/* slots below length() are visible to the caller, each either holds
+		   a constructed element or is a hole left by a failed insert */
+		const T& operator [] ( std::size_t index ) const;
+		T& operator [] ( std::size_t index );
+		bool has( std::size_t index ) const;
+		std::size_t length() const;
+
+
+		class ConstIterator
+		{
+			public:
+				ConstIterator( const ConcurrentArray* array, int step );
+				const T& get() const;
+				void next();
+				bool hasCurrent() const;
+			private:
+				const ConcurrentArray* array;
+				std::size_t index;
+				int step;
+
+				void skip_holes();
+		};
+
+		ConstIterator iterator() const;
+		ConstIterator reverseIterator() const;
+
+	private:
+		enum SlotState : unsigned char { SLOT_EMPTY, SLOT_READY, SLOT_FAILED };
+
+		struct Slot
+		{
+			alignas( T ) unsigned char value[sizeof( T )];
+			std::atomic<unsigned char> state;
+		};
+
+		std::atomic<Slot*> segments[CONCURRENT_SEGMENT_COUNT];
+		std::atomic<std::size_t> reserved;
+		std::atomic<std::size_t> published;
+
+		Slot* segment( int k );
+		Slot* slot( std::size_t index ) const;
+		std::size_t reserve();
+		void publish();
+
+		static int segment_of( std::size_t index );
+		static std::size_t segment_length( int k );
+		static std::size_t segment_first( int k );
+};
+
+
+template<typename T>
+ConcurrentArray<T>::ConcurrentArray():
+	reserved( 0 ),
+	published( 0 )
+{
+	for ( int k = 0; k < CONCURRENT_SEGMENT_COUNT; k++ )
+	{
+		segments[k].store( nullptr );
+	}
+}
+
+
+/* must not run concurrently with writers */
+template<typename T>
+ConcurrentArray<T>::~ConcurrentArray()
+{
+	std::size_t count = reserved.load();
+	for ( std::size_t i = 0; i < count; i++ )
+	{
+		Slot* s = slot( i );
+		if ( s != nullptr && s->state.load() == SLOT_READY )
+		{
+			reinterpret_cast<T*>( s->value )->~T();
+		}
+	}
+	for ( int k = 0; k < CONCURRENT_SEGMENT_COUNT; k++ )
+	{
+		std::free( segments[k].load() );
+	}
+}
+
+
+template<typename T>
+int ConcurrentArray<T>::segment_of( std::size_t index )
+{
+	std::size_t j = index / CONCURRENT_FIRST_SEGMENT_LENGTH + 1;
+	int k = 0;
+	while ( j >>= 1 )
+	{
+		k++;
+	}
+	return k;
+}
+
+
+template<typename T>
+std::size_t ConcurrentArray<T>::segment_length( int k )
+{
+	return CONCURRENT_FIRST_SEGMENT_LENGTH << k;
+}
+
+
+template<typename T>
+std::size_t ConcurrentArray<T>::segment_first( int k )
+{
+	return CONCURRENT_FIRST_SEGMENT_LENGTH * ( ( (std::size_t) 1 << k ) - 1 );
+}
+
+
+/* installing segment k if nobody did it yet, the losing thread frees its copy */
+template<typename T>
+typename ConcurrentArray<T>::Slot* ConcurrentArray<T>::segment( int k )
+{
+	Slot* current = segments[k].load();
+	if ( current != nullptr )
+	{
+		return current;
+	}
+	Slot* fresh = (Slot*) std::malloc( segment_length( k ) * sizeof( Slot ) );
+	if ( fresh == nullptr )
+	{
+		throw std::bad_alloc();
+	}
+	for ( std::size_t i = 0; i < segment_length( k ); i++ )
+	{
+		new( &fresh[i].state ) std::atomic<unsigned char>( SLOT_EMPTY );
+	}
+	if ( segments[k].compare_exchange_strong( current, fresh ) )
+	{
+		return fresh;
+	}
+	std::free( fresh );
+	return current;
+}
+
+
+template<typename T>
+typename ConcurrentArray<T>::Slot* ConcurrentArray<T>::slot( std::size_t index ) const
+{
+	int k = segment_of( index );
+	Slot* s = segments[k].load();
+	return s != nullptr ? s + ( index - segment_first( k ) ) : nullptr;
+}
+
+
+/* taking the next index; its segment is installed before the index is
+   taken, so running out of memory or of segments leaves no gap behind */
+template<typename T>
+std::size_t ConcurrentArray<T>::reserve()
+{
+	std::size_t index = reserved.load();
+	do
+	{
+		if ( index >= segment_first( CONCURRENT_SEGMENT_COUNT ) )
+		{
+			throw std::length_error( "ConcurrentArray is full" );
+		}
+		segment( segment_of( index ) );
+	}
+	while ( !reserved.compare_exchange_weak( index, index + 1 ) );
+	return index;
+}
+
+
+/* moving the published border over every filled or failed slot, whoever
+   fills the first missing slot carries the border past the ones after it */
+template<typename T>
+void ConcurrentArray<T>::publish()
+{
+	std::size_t p = published.load();
+	while ( p < reserved.load() )
+	{
+		Slot* s = slot( p );
+		if ( s == nullptr || s->state.load() == SLOT_EMPTY )
+		{
+			return;
+		}
+		if ( published.compare_exchange_weak( p, p + 1 ) )
+		{
+			p++;
+		}
+	}
+}
+
+
+template<typename T>
+std::size_t ConcurrentArray<T>::insert( const T& value )
+{
+	return emplace_back( value );
+}
+
+
+template<typename T>
+std::size_t ConcurrentArray<T>::insert( T&& value )
+{
+	return emplace_back( std::move( value ) );
+}
+
+
+template<typename T>
+template<typename... Args>
+std::size_t ConcurrentArray<T>::emplace_back( Args&&... args )
+{
+	std::size_t index = reserve();
+	Slot* s = slot( index );
+	try
+	{
+		new( s->value ) T( std::forward<Args>( args )... );
+	}
+	catch ( ... )
+	{
+		/* the border must not stop at this slot forever */
+		s->state.store( SLOT_FAILED );
+		publish();
+		throw;
+	}
+	s->state.store( SLOT_READY );
+	publish();
+	return index;
+}
+
+
+template<typename T>
+const T& ConcurrentArray<T>::operator [] ( std::size_t index ) const
+{
+	return *reinterpret_cast<const T*>( slot( index )->value );
+}
+
+
+template<typename T>
+T& ConcurrentArray<T>::operator [] ( std::size_t index )
+{
+	return *reinterpret_cast<T*>( slot( index )->value );
+}
+
+
+/* false for the hole of an insert that threw */
+template<typename T>
+bool ConcurrentArray<T>::has( std::size_t index ) const
+{
+	return slot( index )->state.load() == SLOT_READY;
+}
+
+
+template<typename T>
+std::size_t ConcurrentArray<T>::length() const
+{
+	return published.load();
+}
+
+
+
+/* iterators */
+
+
+template<typename T>
+ConcurrentArray<T>::ConstIterator::ConstIterator( const ConcurrentArray<T>* array, int step ):
+	array( array ),
+	index( step > 0 ? 0 : ( array->length() - 1 ) ),
+	step( step )
+{
+	skip_holes();
+}
+
+template<typename T>
+void ConcurrentArray<T>::ConstIterator::next()
+{
+	index += step;
+	skip_holes();
+}
+
+template<typename T>
+void ConcurrentArray<T>::ConstIterator::skip_holes()
+{
+	while ( hasCurrent() && !array->has( index ) )
+	{
+		index += step;
+	}
+}
+
+template<typename T>
+bool ConcurrentArray<T>::ConstIterator::hasCurrent() const
+{
+	/* stepping below 0 wraps around to a huge index */
+	return index < array->length();
+}
+
+template<typename T>
+const T& ConcurrentArray<T>::ConstIterator::get() const
+{
+	return ( *array )[index];
+}
+
+
+template<typename T>
+typename ConcurrentArray<T>::ConstIterator ConcurrentArray<T>::iterator() const
+{
+	ConcurrentArray<T>::ConstIterator iterator( this, 1 );
+	return iterator;
+}
+
+template<typename T>
+typename ConcurrentArray<T>::ConstIterator ConcurrentArray<T>::reverseIterator() const
+{
+	ConcurrentArray<T>::ConstIterator iterator( this, -1 );
+	return iterator;
+}
\ No newline at end of file
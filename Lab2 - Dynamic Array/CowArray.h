@@ -0,0 +1,240 @@
+#pragma once
+
+#include <atomic>
+#include <utility>
+
+#include "Array.h"
+
+/* copy-on-write array: copies share one buffer with a reference count and
+   the first write through a shared copy duplicates the whole buffer, so a
+   snapshot costs one counter increment until someone modifies it.
+   A non-const operator [] or begin() hands out a writable reference, so
+   the buffer stops being shared: copies made after that get their own
+   buffer. insert and remove make it shareable again and, as for Array,
+   invalidate the references handed out before */
+
+/* Chunk-level sharing is not done: insert and remove shift every element
+   after the index anyway, and data()/begin() must stay contiguous. */
+
+template<typename T>
+class CowArray final
+{
+	public:
+		CowArray();
+		CowArray( std::size_t capacity );
+		explicit CowArray( Array<T> array );
+		/* a snapshot: shares the buffer unless a writable reference into it
+		   was handed out; no move operations, so a moved-from array stays
+		   valid. Copies may be used from different threads (the reference
+		   count synchronizes them), but one CowArray object must not be
+		   copied while it is being written */
+		CowArray( const CowArray& other );
+		~CowArray();
+
+		CowArray& operator = ( const CowArray& other );
+
+		std::size_t insert( const T& value );
+		std::size_t insert( std::size_t index, const T& value );
+		void remove( std::size_t index );
+
+		/* the const overload only reads; the other one makes the buffer
+		   private first, so read through a const reference if possible */
+		const T& operator [] ( std::size_t index ) const;
+		T& operator [] ( std::size_t index );
+		std::size_t length() const;
+
+		/* whether another copy shares the buffer */
+		bool is_shared() const;
+		const Array<T>& array() const;
+
+		const T* begin() const;
+		const T* end() const;
+		T* begin();
+		T* end();
+
+	private:
+		struct Buffer
+		{
+			std::atomic<std::size_t> references;
+			/* false while writable references into array may be in use */
+			bool shareable;
+			Array<T> array;
+
+			Buffer( Array<T> array ): references( 1 ), shareable( true ), array( std::move( array ) ) {}
+		};
+
+		Buffer* buffer;
+
+		Array<T>& writable();
+		void release();
+};
+
+
+template<typename T>
+CowArray<T>::CowArray():
+	buffer( new Buffer( Array<T>() ) )
+{}
+
+
+template<typename T>
+CowArray<T>::CowArray( std::size_t capacity ):
+	buffer( new Buffer( Array<T>( capacity ) ) )
+{}
+
+
+template<typename T>
+CowArray<T>::CowArray( Array<T> array ):
+	buffer( new Buffer( std::move( array ) ) )
+{}
+
+
+template<typename T>
+CowArray<T>::CowArray( const CowArray<T>& other )
+{
+	if ( other.buffer->shareable )
+	{
+		buffer = other.buffer;
+		buffer->references.fetch_add( 1, std::memory_order_relaxed );
+	}
+	else
+	{
+		buffer = new Buffer( other.buffer->array );
+	}
+}
+
+
+template<typename T>
+CowArray<T>::~CowArray()
+{
+	release();
+}
+
+
+template<typename T>
+CowArray<T>& CowArray<T>::operator = ( const CowArray<T>& other )
+{
+	CowArray<T> copy( other );
+	std::swap( buffer, copy.buffer );
+	return *this;
+}
+
+
+/* the last owner deletes the buffer; acq_rel orders the reads of the
+   other owners before the deletion */
+template<typename T>
+void CowArray<T>::release()
+{
+	if ( buffer->references.fetch_sub( 1, std::memory_order_acq_rel ) == 1 )
+	{
+		delete buffer;
+	}
+}
+
+
+/* the buffer copied if it is shared; the acquire load pairs with the
+   release of the copies that dropped it, so their reads happen before
+   the writes of this owner */
+template<typename T>
+Array<T>& CowArray<T>::writable()
+{
+	if ( buffer->references.load( std::memory_order_acquire ) > 1 )
+	{
+		Buffer* copy = new Buffer( buffer->array );
+		release();
+		buffer = copy;
+	}
+	return buffer->array;
+}
+
+
+template<typename T>
+std::size_t CowArray<T>::insert( const T& value )
+{
+	Array<T>& array = writable();
+	buffer->shareable = true;
+	return array.insert( value );
+}
+
+
+template<typename T>
+std::size_t CowArray<T>::insert( std::size_t index, const T& value )
+{
+	Array<T>& array = writable();
+	buffer->shareable = true;
+	return array.insert( index, value );
+}
+
+
+template<typename T>
+void CowArray<T>::remove( std::size_t index )
+{
+	Array<T>& array = writable();
+	buffer->shareable = true;
+	array.remove( index );
+}
+
+
+template<typename T>
+const T& CowArray<T>::operator [] ( std::size_t index ) const
+{
+	return buffer->array[index];
+}
+
+
+template<typename T>
+T& CowArray<T>::operator [] ( std::size_t index )
+{
+	Array<T>& array = writable();
+	buffer->shareable = false;
+	return array[index];
+}
+
+
+template<typename T>
+std::size_t CowArray<T>::length() const
+{
+	return buffer->array.length();
+}
+
+
+template<typename T>
+bool CowArray<T>::is_shared() const
+{
+	return buffer->references.load( std::memory_order_acquire ) > 1;
+}
+
+
+template<typename T>
+const Array<T>& CowArray<T>::array() const
+{
+	return buffer->array;
+}
+
+
+template<typename T>
+const T* CowArray<T>::begin() const
+{
+	return buffer->array.begin();
+}
+
+template<typename T>
+const T* CowArray<T>::end() const
+{
+	return buffer->array.end();
+}
+
+template<typename T>
+T* CowArray<T>::begin()
+{
+	Array<T>& array = writable();
+	buffer->shareable = false;
+	return array.begin();
+}
+
+template<typename T>
+T* CowArray<T>::end()
+{
+	Array<T>& array = writable();
+	buffer->shareable = false;
+	return array.end();
+}
@@ -0,0 +1,399 @@
+#pragma once
+
+#include <algorithm>
+#include <functional>
+#include <utility>
+
+#include "Array.h"
+
+/* sorted containers in contiguous memory: lookups are binary searches over
+   one dense array of keys, batches are sorted and merged in one pass */
+
+
+/* index of the first element of a[0, n) not less than key; the search
+   loop has no data-dependent branch (the compiler emits a conditional move) */
+template<typename T, typename Compare>
+std::size_t branchless_lower_bound( const T* a, std::size_t n, const T& key, Compare less )
+{
+	const T* base = a;
+	while ( n > 1 )
+	{
+		std::size_t half = n / 2;
+		base = less( base[half], key ) ? base + half : base;
+		n -= half;
+	}
+	return (std::size_t) ( base - a ) + ( n == 1 && less( *base, key ) ? 1 : 0 );
+}
+
+
+template<typename Key, typename Compare = std::less<Key>>
+class FlatSet final
+{
+	public:
+		FlatSet( Compare less = Compare() );
+		/* bulk construction from unsorted data, duplicates are dropped */
+		FlatSet( const Key* first, const Key* last, Compare less = Compare() );
+
+		/* false if an equal key is already there */
+		bool insert( const Key& key );
+		/* sorting the batch and merging it in, returns the number of new keys */
+		std::size_t insert( const Key* first, const Key* last );
+		bool remove( const Key& key );
+
+		std::size_t lower_bound( const Key& key ) const;
+		/* index of key or length() if absent */
+		std::size_t find( const Key& key ) const;
+		bool contains( const Key& key ) const;
+
+		const Key& operator [] ( std::size_t index ) const;
+		std::size_t length() const;
+		const Key* begin() const;
+		const Key* end() const;
+
+	private:
+		Array<Key> keys;
+		Compare less;
+
+		bool equal( const Key& x, const Key& y ) const;
+};
+
+
+template<typename Key, typename Compare>
+FlatSet<Key, Compare>::FlatSet( Compare less ):
+	less( less )
+{}
+
+
+template<typename Key, typename Compare>
+FlatSet<Key, Compare>::FlatSet( const Key* first, const Key* last, Compare less ):
+	less( less )
+{
+	insert( first, last );
+}
+
+
+template<typename Key, typename Compare>
+bool FlatSet<Key, Compare>::equal( const Key& x, const Key& y ) const
+{
+	return !less( x, y ) && !less( y, x );
+}
+
+
+template<typename Key, typename Compare>
+std::size_t FlatSet<Key, Compare>::lower_bound( const Key& key ) const
+{
+	return branchless_lower_bound( keys.data(), keys.length(), key, less );
+}
+
+
+template<typename Key, typename Compare>
+std::size_t FlatSet<Key, Compare>::find( const Key& key ) const
+{
+	std::size_t index = lower_bound( key );
+	return index < keys.length() && !less( key, keys[index] ) ? index : keys.length();
+}
+
+
+template<typename Key, typename Compare>
+bool FlatSet<Key, Compare>::contains( const Key& key ) const
+{
+	return find( key ) < keys.length();
+}
+
+
+template<typename Key, typename Compare>
+bool FlatSet<Key, Compare>::insert( const Key& key )
+{
+	std::size_t index = lower_bound( key );
+	if ( index < keys.length() && !less( key, keys[index] ) )
+	{
+		return false;
+	}
+	keys.insert( index, key );
+	return true;
+}
+
+
+template<typename Key, typename Compare>
+std::size_t FlatSet<Key, Compare>::insert( const Key* first, const Key* last )
+{
+	Array<Key> batch( last > first ? (std::size_t) ( last - first ) : 0 );
+	batch.append( first, last );
+	std::sort( batch.begin(), batch.end(), less );
+	batch.erase( std::unique( batch.begin(), batch.end(), [this]( const Key& x, const Key& y ) { return equal( x, y ); } ) - batch.begin(), batch.length() );
+
+	Array<Key> merged( keys.length() + batch.length() );
+	std::size_t i = 0;
+	std::size_t j = 0;
+	while ( i < keys.length() || j < batch.length() )
+	{
+		if ( j == batch.length() || ( i < keys.length() && less( keys[i], batch[j] ) ) )
+		{
+			merged.insert( std::move( keys[i++] ) );
+		}
+		else if ( i == keys.length() || less( batch[j], keys[i] ) )
+		{
+			merged.insert( std::move( batch[j++] ) );
+		}
+		else
+		{
+			/* the key is already there */
+			merged.insert( std::move( keys[i++] ) );
+			j++;
+		}
+	}
+	std::size_t added = merged.length() - keys.length();
+	keys = std::move( merged );
+	return added;
+}
+
+
+template<typename Key, typename Compare>
+bool FlatSet<Key, Compare>::remove( const Key& key )
+{
+	std::size_t index = find( key );
+	if ( index == keys.length() )
+	{
+		return false;
+	}
+	keys.remove( index );
+	return true;
+}
+
+
+template<typename Key, typename Compare>
+const Key& FlatSet<Key, Compare>::operator [] ( std::size_t index ) const
+{
+	return keys[index];
+}
+
+
+template<typename Key, typename Compare>
+std::size_t FlatSet<Key, Compare>::length() const
+{
+	return keys.length();
+}
+
+
+template<typename Key, typename Compare>
+const Key* FlatSet<Key, Compare>::begin() const
+{
+	return keys.begin();
+}
+
+
+template<typename Key, typename Compare>
+const Key* FlatSet<Key, Compare>::end() const
+{
+	return keys.end();
+}
+
+
+
+/* keys and values are kept in two parallel arrays, so a lookup reads
+   only the keys */
+template<typename Key, typename Value, typename Compare = std::less<Key>>
+class FlatMap final
+{
+	public:
+		FlatMap( Compare less = Compare() );
+		/* bulk construction from unsorted pairs, of equal keys the first one is kept */
+		FlatMap( const std::pair<Key, Value>* first, const std::pair<Key, Value>* last, Compare less = Compare() );
+
+		/* false (and the old value kept) if the key is already there */
+		bool insert( const Key& key, const Value& value );
+		/* sorting the batch and merging it in, returns the number of new keys */
+		std::size_t insert( const std::pair<Key, Value>* first, const std::pair<Key, Value>* last );
+		bool remove( const Key& key );
+
+		/* value of key, default-constructed and inserted if absent */
+		Value& operator [] ( const Key& key );
+		/* nullptr if absent */
+		Value* find( const Key& key );
+		const Value* find( const Key& key ) const;
+		bool contains( const Key& key ) const;
+
+		std::size_t length() const;
+		const Key& key( std::size_t index ) const;
+		Value& value( std::size_t index );
+		const Value& value( std::size_t index ) const;
+
+	private:
+		Array<Key> keys;
+		Array<Value> values;
+		Compare less;
+
+		std::size_t index_of( const Key& key ) const;
+};
+
+
+template<typename Key, typename Value, typename Compare>
+FlatMap<Key, Value, Compare>::FlatMap( Compare less ):
+	less( less )
+{}
+
+
+template<typename Key, typename Value, typename Compare>
+FlatMap<Key, Value, Compare>::FlatMap( const std::pair<Key, Value>* first, const std::pair<Key, Value>* last, Compare less ):
+	less( less )
+{
+	insert( first, last );
+}
+
+
+/* index of key or length() if absent */
+template<typename Key, typename Value, typename Compare>
+std::size_t FlatMap<Key, Value, Compare>::index_of( const Key& key ) const
+{
+	std::size_t index = branchless_lower_bound( keys.data(), keys.length(), key, less );
+	return index < keys.length() && !less( key, keys[index] ) ? index : keys.length();
+}
+
+
+template<typename Key, typename Value, typename Compare>
+bool FlatMap<Key, Value, Compare>::insert( const Key& key, const Value& value )
+{
+	std::size_t index = branchless_lower_bound( keys.data(), keys.length(), key, less );
+	if ( index < keys.length() && !less( key, keys[index] ) )
+	{
+		return false;
+	}
+	keys.insert( index, key );
+	try
+	{
+		values.insert( index, value );
+	}
+	catch ( ... )
+	{
+		/* no key without a value */
+		keys.remove( index );
+		throw;
+	}
+	return true;
+}
+
+
+template<typename Key, typename Value, typename Compare>
+std::size_t FlatMap<Key, Value, Compare>::insert( const std::pair<Key, Value>* first, const std::pair<Key, Value>* last )
+{
+	auto pair_less = [this]( const std::pair<Key, Value>& x, const std::pair<Key, Value>& y ) { return less( x.first, y.first ); };
+	Array<std::pair<Key, Value>> batch( last > first ? (std::size_t) ( last - first ) : 0 );
+	batch.append( first, last );
+	std::stable_sort( batch.begin(), batch.end(), pair_less );
+
+	std::size_t capacity = keys.length() + batch.length();
+	Array<Key> merged_keys( capacity );
+	Array<Value> merged_values( capacity );
+	std::size_t i = 0;
+	std::size_t j = 0;
+	while ( i < keys.length() || j < batch.length() )
+	{
+		if ( j < batch.length() && merged_keys.length() > 0 && !less( merged_keys[merged_keys.length() - 1], batch[j].first ) )
+		{
+			/* the key is already there, from the array or earlier in the batch */
+			j++;
+		}
+		else if ( j == batch.length() || ( i < keys.length() && !less( batch[j].first, keys[i] ) ) )
+		{
+			merged_keys.insert( std::move( keys[i] ) );
+			merged_values.insert( std::move( values[i] ) );
+			i++;
+		}
+		else
+		{
+			merged_keys.insert( std::move( batch[j].first ) );
+			merged_values.insert( std::move( batch[j].second ) );
+			j++;
+		}
+	}
+	std::size_t added = merged_keys.length() - keys.length();
+	keys = std::move( merged_keys );
+	values = std::move( merged_values );
+	return added;
+}
+
+
+template<typename Key, typename Value, typename Compare>
+bool FlatMap<Key, Value, Compare>::remove( const Key& key )
+{
+	std::size_t index = index_of( key );
+	if ( index == keys.length() )
+	{
+		return false;
+	}
+	keys.remove( index );
+	values.remove( index );
+	return true;
+}
+
+
+template<typename Key, typename Value, typename Compare>
+Value& FlatMap<Key, Value, Compare>::operator [] ( const Key& key )
+{
+	std::size_t index = branchless_lower_bound( keys.data(), keys.length(), key, less );
+	if ( index == keys.length() || less( key, keys[index] ) )
+	{
+		keys.insert( index, key );
+		try
+		{
+			values.emplace( index );
+		}
+		catch ( ... )
+		{
+			keys.remove( index );
+			throw;
+		}
+	}
+	return values[index];
+}
+
+
+template<typename Key, typename Value, typename Compare>
+Value* FlatMap<Key, Value, Compare>::find( const Key& key )
+{
+	std::size_t index = index_of( key );
+	return index < keys.length() ? &values[index] : nullptr;
+}
+
+
+template<typename Key, typename Value, typename Compare>
+const Value* FlatMap<Key, Value, Compare>::find( const Key& key ) const
+{
+	std::size_t index = index_of( key );
+	return index < keys.length() ? &values[index] : nullptr;
+}
+
+
+template<typename Key, typename Value, typename Compare>
+bool FlatMap<Key, Value, Compare>::contains( const Key& key ) const
+{
+	return index_of( key ) < keys.length();
+}
+
+
+template<typename Key, typename Value, typename Compare>
+std::size_t FlatMap<Key, Value, Compare>::length() const
+{
+	return keys.length();
+}
+
+
+template<typename Key, typename Value, typename Compare>
+const Key& FlatMap<Key, Value, Compare>::key( std::size_t index ) const
+{
+	return keys[index];
+}
+
+
+template<typename Key, typename Value, typename Compare>
+Value& FlatMap<Key, Value, Compare>::value( std::size_t index )
+{
+	return values[index];
+}
+
+
+template<typename Key, typename Value, typename Compare>
+const Value& FlatMap<Key, Value, Compare>::value( std::size_t index ) const
+{
+	return values[index];
+}
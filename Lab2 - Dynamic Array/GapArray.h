@@ -0,0 +1,391 @@
+#pragma once
+
+#include <limits>
+#include <new>
+#include <stdexcept>
+
+#include "Array.h"
+
+/* gap buffer: dynamic array with a hole of free slots kept at the last
+   edit position, so edits near each other cost O(distance) instead of O(n) */
+
+template<typename T>
+class GapArray final
+{
+	public:
+		GapArray();
+		GapArray( std::size_t capacity );
+		GapArray( const GapArray& other );
+		GapArray( GapArray&& other );
+		~GapArray();
+
+		GapArray& operator = ( const GapArray& other );
+		GapArray& operator = ( GapArray&& other );
+
+		std::size_t insert( const T& value );
+		std::size_t insert( std::size_t index, const T& value );
+		void remove( std::size_t index );
+
+		const T& operator [] ( std::size_t index ) const;
+		T& operator [] ( std::size_t index );
+		std::size_t length() const;
+
+
+		class Iterator
+		{
+			public:
+				Iterator( GapArray* array, int step );
+				T& get() const;
+				void set( const T& value );
+				void next();
+				bool hasCurrent() const;
+			private:
+				GapArray* array;
+				std::size_t index;
+				int step;
+		};
+
+		Iterator iterator();
+		Iterator reverseIterator();
+
+		class ConstIterator
+		{
+			public:
+				ConstIterator( const GapArray* array, int step );
+				const T& get() const;
+				void next();
+				bool hasCurrent() const;
+			private:
+				const GapArray* array;
+				std::size_t index;
+				int step;
+		};
+
+		ConstIterator iterator() const;
+		ConstIterator reverseIterator() const;
+
+	private:
+		std::size_t capacity;
+		std::size_t gap_start;
+		std::size_t gap_end;
+		T* a;
+
+		void clear();
+		void move_gap( std::size_t index );
+		void enlarge_capacity();
+
+		static T* allocate( std::size_t capacity );
+};
+
+
+/* default costructor */
+template<typename T>
+GapArray<T>::GapArray():
+	GapArray( DEFAULT_ARRAY_CAPACITY )
+{}
+
+
+/* with parameter */
+template<typename T>
+GapArray<T>::GapArray( std::size_t capacity ):
+	capacity( capacity > 0 ? capacity : DEFAULT_ARRAY_CAPACITY ),
+	gap_start( 0 ),
+	gap_end( this->capacity ),
+	a( allocate( this->capacity ) )
+{}
+
+
+template<typename T>
+T* GapArray<T>::allocate( std::size_t capacity )
+{
+	if ( capacity > std::numeric_limits<std::size_t>::max() / sizeof( T ) )
+	{
+		throw std::length_error( "GapArray capacity is too big" );
+	}
+	T* memory = (T*) std::malloc( capacity * sizeof( T ) );
+	if ( memory == nullptr )
+	{
+		throw std::bad_alloc();
+	}
+	return memory;
+}
+
+
+/* copy constructor, the copy gets its gap at the end */
+template<typename T>
+GapArray<T>::GapArray( const GapArray<T>& other ):
+	GapArray( other.capacity )
+{
+	/* gap_start counts only constructed elements: if a copy throws,
+	   the destructor destroys just those */
+	for ( ; gap_start < other.length(); gap_start++ )
+	{
+		new( a + gap_start ) T( other[gap_start] );
+	}
+}
+
+
+/* move constructor */
+template<typename T>
+GapArray<T>::GapArray( GapArray<T>&& other ):
+	capacity( other.capacity ),
+	gap_start( other.gap_start ),
+	gap_end( other.gap_end ),
+	a( other.a )
+{
+	other.a = nullptr;
+	other.capacity = 0;
+	other.gap_start = 0;
+	other.gap_end = 0;
+}
+
+
+/* destructor */
+template<typename T>
+GapArray<T>::~GapArray()
+{
+	clear();
+}
+
+
+/* copy assignment */
+template<typename T>
+GapArray<T>& GapArray<T>::operator = ( const GapArray<T>& other )
+{
+	GapArray<T> copy( other );
+	std::swap( capacity, copy.capacity );
+	std::swap( gap_start, copy.gap_start );
+	std::swap( gap_end, copy.gap_end );
+	std::swap( a, copy.a );
+	return *this;
+}
+
+
+/* move assignment */
+template<typename T>
+GapArray<T>& GapArray<T>::operator = ( GapArray<T>&& other )
+{
+	if ( this != &other )
+	{
+		clear();
+		capacity = other.capacity;
+		gap_start = other.gap_start;
+		gap_end = other.gap_end;
+		a = other.a;
+		other.a = nullptr;
+		other.capacity = 0;
+		other.gap_start = 0;
+		other.gap_end = 0;
+	}
+	return *this;
+}
+
+
+/* memory freeing */
+template<typename T>
+void GapArray<T>::clear()
+{
+	if constexpr ( !std::is_trivially_destructible<T>::value )
+	{
+		for ( std::size_t i = 0; i < gap_start; i++ )
+		{
+			a[i].~T();
+		}
+		for ( std::size_t i = gap_end; i < capacity; i++ )
+		{
+			a[i].~T();
+		}
+	}
+	std::free( a );
+}
+
+
+/* moving the gap so that it starts at index */
+template<typename T>
+void GapArray<T>::move_gap( std::size_t index )
+{
+	if ( index < gap_start )
+	{
+		std::size_t count = gap_start - index;
+		relocate( a + index, a + gap_end - count, count );
+		gap_start -= count;
+		gap_end -= count;
+	}
+	else if ( index > gap_start )
+	{
+		std::size_t count = index - gap_start;
+		relocate( a + gap_end, a + gap_start, count );
+		gap_start += count;
+		gap_end += count;
+	}
+}
+
+
+/* doubling capacity, the gap stays at its position and takes the new space;
+   doubling stops at the largest capacity whose size in bytes fits std::size_t */
+template<typename T>
+void GapArray<T>::enlarge_capacity()
+{
+	const std::size_t max_capacity = std::numeric_limits<std::size_t>::max() / sizeof( T );
+	if ( capacity >= max_capacity )
+	{
+		throw std::length_error( "GapArray capacity is too big" );
+	}
+	std::size_t new_capacity = capacity > max_capacity / 2 ? max_capacity : capacity * 2;
+	new_capacity = new_capacity > 0 ? new_capacity : DEFAULT_ARRAY_CAPACITY;
+	std::size_t tail = capacity - gap_end;
+	T* a_enlarged = allocate( new_capacity );
+	relocate( a, a_enlarged, gap_start );
+	relocate( a + gap_end, a_enlarged + new_capacity - tail, tail );
+	std::free( a );
+	a = a_enlarged;
+	capacity = new_capacity;
+	gap_end = new_capacity - tail;
+}
+
+
+template<typename T>
+std::size_t GapArray<T>::insert( const T& value )
+{
+	return insert( length(), value );
+}
+
+
+template<typename T>
+std::size_t GapArray<T>::insert( std::size_t index, const T& value )
+{
+	/* value may be an element of the array itself */
+	T copy( value );
+	move_gap( index );
+	if ( gap_start == gap_end )
+	{
+		enlarge_capacity();
+	}
+	new( a + gap_start ) T( std::move( copy ) );
+	gap_start++;
+	return index;
+}
+
+
+template<typename T>
+void GapArray<T>::remove( std::size_t index )
+{
+	move_gap( index );
+	a[gap_end].~T();
+	gap_end++;
+}
+
+
+template<typename T>
+const T& GapArray<T>::operator [] ( std::size_t index ) const
+{
+	return index < gap_start ? a[index] : a[index + gap_end - gap_start];
+}
+
+
+template<typename T>
+T& GapArray<T>::operator [] ( std::size_t index )
+{
+	return index < gap_start ? a[index] : a[index + gap_end - gap_start];
+}
+
+
+template<typename T>
+std::size_t GapArray<T>::length() const
+{
+	return capacity - ( gap_end - gap_start );
+}
+
+
+
+/* iterators */
+
+
+template<typename T>
+GapArray<T>::Iterator::Iterator( GapArray<T>* array, int step ):
+	array( array ),
+	index( step > 0 ? 0 : ( array->length() - 1 ) ),
+	step( step )
+{}
+
+template<typename T>
+void GapArray<T>::Iterator::next()
+{
+	index += step;
+}
+
+template<typename T>
+bool GapArray<T>::Iterator::hasCurrent() const
+{
+	/* stepping below 0 wraps around to a huge index */
+	return index < array->length();
+}
+
+template<typename T>
+T& GapArray<T>::Iterator::get() const
+{
+	return ( *array )[index];
+}
+
+template<typename T>
+void GapArray<T>::Iterator::set( const T& value )
+{
+	( *array )[index] = value;
+}
+
+
+template<typename T>
+GapArray<T>::ConstIterator::ConstIterator( const GapArray<T>* array, int step ):
+	array( array ),
+	index( step > 0 ? 0 : ( array->length() - 1 ) ),
+	step( step )
+{}
+
+template<typename T>
+void GapArray<T>::ConstIterator::next()
+{
+	index += step;
+}
+
+template<typename T>
+bool GapArray<T>::ConstIterator::hasCurrent() const
+{
+	/* stepping below 0 wraps around to a huge index */
+	return index < array->length();
+}
+
+template<typename T>
+const T& GapArray<T>::ConstIterator::get() const
+{
+	return ( *array )[index];
+}
+
+
+
+template<typename T>
+typename GapArray<T>::Iterator GapArray<T>::iterator()
+{
+	GapArray<T>::Iterator iterator( this, 1 );
+	return iterator;
+}
+
+template<typename T>
+typename GapArray<T>::ConstIterator GapArray<T>::iterator() const
+{
+	GapArray<T>::ConstIterator iterator( this, 1 );
+	return iterator;
+}
+
+template<typename T>
+typename GapArray<T>::Iterator GapArray<T>::reverseIterator()
+{
+	GapArray<T>::Iterator iterator( this, -1 );
+	return iterator;
+}
+
+template<typename T>
+typename GapArray<T>::ConstIterator GapArray<T>::reverseIterator() const
+{
+	GapArray<T>::ConstIterator iterator( this, -1 );
+	return iterator;
+}
\ No newline at end of file
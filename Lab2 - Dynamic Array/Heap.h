@@ -0,0 +1,260 @@
+#pragma once
+
+#include <functional>
+#include <stdexcept>
+#include <utility>
+
+#include "Array.h"
+
+/* d-ary heap priority queue on Array: top() is the least element by Compare
+   (a min-heap with the default std::less). Node i has children D*i+1..D*i+D,
+   so with D = 4 the heap is half as deep as a binary one and the children
+   compared at each level lie next to each other in memory.
+   push returns a handle which stays valid until the element is popped
+   and lets decrease_key / update find the element in O(1) */
+
+constexpr std::size_t DEFAULT_HEAP_ARITY = 4;
+
+template<typename T, std::size_t D = DEFAULT_HEAP_ARITY, typename Compare = std::less<T>>
+class Heap final
+{
+	static_assert( D >= 2, "heap arity must be at least 2" );
+
+	public:
+		using Handle = std::size_t;
+
+		Heap( Compare less = Compare() );
+		/* bulk heapify in O(n), the elements get handles 0, 1, 2, ... in order */
+		Heap( const T* first, const T* last, Compare less = Compare() );
+
+		Handle push( const T& value );
+		Handle push( T&& value );
+		const T& top() const;
+		T pop();
+
+		/* value must not be greater than the current one */
+		void decrease_key( Handle handle, const T& value );
+		/* any new value */
+		void update( Handle handle, const T& value );
+		const T& get( Handle handle ) const;
+		bool contains( Handle handle ) const;
+
+		std::size_t length() const;
+
+	private:
+		static constexpr std::size_t NO_POSITION = (std::size_t) -1;
+
+		struct Node
+		{
+			T value;
+			Handle handle;
+		};
+
+		Array<Node> nodes;
+		/* heap index per handle, NO_POSITION for popped ones */
+		Array<std::size_t> positions;
+		Array<Handle> free_handles;
+		Compare less;
+
+		Handle new_handle();
+		void place( std::size_t index, Node&& node );
+		void sift_up( std::size_t index );
+		void sift_down( std::size_t index );
+};
+
+
+template<typename T, std::size_t D, typename Compare>
+Heap<T, D, Compare>::Heap( Compare less ):
+	less( less )
+{}
+
+
+template<typename T, std::size_t D, typename Compare>
+Heap<T, D, Compare>::Heap( const T* first, const T* last, Compare less ):
+	nodes( last > first ? (std::size_t) ( last - first ) : 0 ),
+	positions( last > first ? (std::size_t) ( last - first ) : 0 ),
+	less( less )
+{
+	for ( const T* p = first; p < last; p++ )
+	{
+		positions.insert( nodes.length() );
+		nodes.insert( Node{ *p, nodes.length() } );
+	}
+	if ( nodes.length() < 2 )
+	{
+		return;
+	}
+	for ( std::size_t i = ( nodes.length() - 2 ) / D + 1; i > 0; i-- )
+	{
+		sift_down( i - 1 );
+	}
+}
+
+
+template<typename T, std::size_t D, typename Compare>
+typename Heap<T, D, Compare>::Handle Heap<T, D, Compare>::new_handle()
+{
+	if ( free_handles.length() > 0 )
+	{
+		Handle handle = free_handles[free_handles.length() - 1];
+		free_handles.remove( free_handles.length() - 1 );
+		return handle;
+	}
+	return positions.insert( NO_POSITION );
+}
+
+
+template<typename T, std::size_t D, typename Compare>
+void Heap<T, D, Compare>::place( std::size_t index, Node&& node )
+{
+	nodes[index] = std::move( node );
+	positions[nodes[index].handle] = index;
+}
+
+
+/* moving the element at index towards the root while it is less than its parent */
+template<typename T, std::size_t D, typename Compare>
+void Heap<T, D, Compare>::sift_up( std::size_t index )
+{
+	Node node = std::move( nodes[index] );
+	while ( index > 0 )
+	{
+		std::size_t parent = ( index - 1 ) / D;
+		if ( !less( node.value, nodes[parent].value ) )
+		{
+			break;
+		}
+		place( index, std::move( nodes[parent] ) );
+		index = parent;
+	}
+	place( index, std::move( node ) );
+}
+
+
+/* moving the element at index down while its least child is less than it */
+template<typename T, std::size_t D, typename Compare>
+void Heap<T, D, Compare>::sift_down( std::size_t index )
+{
+	Node node = std::move( nodes[index] );
+	std::size_t size = nodes.length();
+	while ( true )
+	{
+		std::size_t first_child = D * index + 1;
+		if ( first_child >= size )
+		{
+			break;
+		}
+		std::size_t last_child = first_child + D < size ? first_child + D : size;
+		std::size_t best = first_child;
+		for ( std::size_t child = first_child + 1; child < last_child; child++ )
+		{
+			best = less( nodes[child].value, nodes[best].value ) ? child : best;
+		}
+		if ( !less( nodes[best].value, node.value ) )
+		{
+			break;
+		}
+		place( index, std::move( nodes[best] ) );
+		index = best;
+	}
+	place( index, std::move( node ) );
+}
+
+
+template<typename T, std::size_t D, typename Compare>
+typename Heap<T, D, Compare>::Handle Heap<T, D, Compare>::push( const T& value )
+{
+	return push( T( value ) );
+}
+
+
+template<typename T, std::size_t D, typename Compare>
+typename Heap<T, D, Compare>::Handle Heap<T, D, Compare>::push( T&& value )
+{
+	Handle handle = new_handle();
+	positions[handle] = nodes.insert( Node{ std::move( value ), handle } );
+	sift_up( nodes.length() - 1 );
+	return handle;
+}
+
+
+template<typename T, std::size_t D, typename Compare>
+const T& Heap<T, D, Compare>::top() const
+{
+	if ( nodes.length() == 0 )
+	{
+		throw std::out_of_range( "heap is empty" );
+	}
+	return nodes[0].value;
+}
+
+
+template<typename T, std::size_t D, typename Compare>
+T Heap<T, D, Compare>::pop()
+{
+	if ( nodes.length() == 0 )
+	{
+		throw std::out_of_range( "heap is empty" );
+	}
+	Node root = std::move( nodes[0] );
+	positions[root.handle] = NO_POSITION;
+	free_handles.insert( root.handle );
+	std::size_t last = nodes.length() - 1;
+	if ( last > 0 )
+	{
+		place( 0, std::move( nodes[last] ) );
+	}
+	nodes.remove( last );
+	if ( last > 1 )
+	{
+		sift_down( 0 );
+	}
+	return std::move( root.value );
+}
+
+
+template<typename T, std::size_t D, typename Compare>
+void Heap<T, D, Compare>::decrease_key( Handle handle, const T& value )
+{
+	std::size_t index = positions[handle];
+	nodes[index].value = value;
+	sift_up( index );
+}
+
+
+template<typename T, std::size_t D, typename Compare>
+void Heap<T, D, Compare>::update( Handle handle, const T& value )
+{
+	std::size_t index = positions[handle];
+	bool smaller = less( value, nodes[index].value );
+	nodes[index].value = value;
+	if ( smaller )
+	{
+		sift_up( index );
+	}
+	else
+	{
+		sift_down( index );
+	}
+}
+
+
+template<typename T, std::size_t D, typename Compare>
+const T& Heap<T, D, Compare>::get( Handle handle ) const
+{
+	return nodes[positions[handle]].value;
+}
+
+
+template<typename T, std::size_t D, typename Compare>
+bool Heap<T, D, Compare>::contains( Handle handle ) const
+{
+	return handle < positions.length() && positions[handle] != NO_POSITION;
+}
+
+
+template<typename T, std::size_t D, typename Compare>
+std::size_t Heap<T, D, Compare>::length() const
+{
+	return nodes.length();
+}
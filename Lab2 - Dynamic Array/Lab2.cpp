@@ -7,8 +7,7 @@ int main()
     Array<int> a;
     for ( int i = 0; i < 10; ++i )
         a.insert( i + 1 );
-    for ( int i = 0; i < a.length(); ++i )
-        a[i] *= 2;
+    parallel_transform( a.begin(), a.end(), []( int x ) { return x * 2; } );
     for ( auto it = a.iterator(); it.hasCurrent(); it.next() )
         std::cout << it.get() << std::endl;
     return 0;
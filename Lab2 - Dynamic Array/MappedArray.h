@@ -0,0 +1,377 @@
+#pragma once
+
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#include "Array.h"
+
+/* file-backed array of trivially copyable elements: the file is mapped into
+   memory and holds the length, so reopening it needs no deserialization */
+
+constexpr std::uint64_t MAPPED_ARRAY_MAGIC = 0x5952524150414d41; /* "AMAPARRY" */
+constexpr std::size_t MAPPED_ARRAY_HEADER_SIZE = 64;
+
+template<typename T>
+class MappedArray final
+{
+	static_assert( std::is_trivially_copyable<T>::value, "mapped elements must be trivially copyable" );
+	static_assert( alignof( T ) <= MAPPED_ARRAY_HEADER_SIZE, "element alignment is too big" );
+
+	public:
+		/* opening existing file or creating a new one in an empty or absent file,
+		   throws runtime_error for a file that is not a valid array of T */
+		MappedArray( const std::string& path, std::size_t capacity = DEFAULT_ARRAY_CAPACITY );
+		MappedArray( const MappedArray& other ) = delete;
+		~MappedArray();
+
+		MappedArray& operator = ( const MappedArray& other ) = delete;
+
+		std::size_t insert( const T& value );
+		std::size_t insert( std::size_t index, const T& value );
+		void remove( std::size_t index );
+
+		const T& operator [] ( std::size_t index ) const;
+		T& operator [] ( std::size_t index );
+		std::size_t length() const;
+
+		T* data();
+		const T* data() const;
+		T* begin();
+		T* end();
+		const T* begin() const;
+		const T* end() const;
+
+		/* writing dirty pages to the file */
+		void flush();
+
+	private:
+		struct Header
+		{
+			std::uint64_t magic;
+			std::uint64_t element_size;
+			std::uint64_t size;
+			std::uint64_t capacity;
+		};
+
+#ifdef _WIN32
+		HANDLE file;
+		HANDLE mapping;
+#else
+		int file;
+#endif
+		void* view;
+		std::size_t view_size;
+		Header* header;
+		T* a;
+
+		void map( std::size_t bytes );
+		void unmap();
+		void close();
+		std::size_t grown_capacity() const;
+		void enlarge_capacity( std::size_t shift_index );
+
+		static std::size_t max_capacity();
+		static std::size_t file_size( std::size_t capacity );
+};
+
+
+/* most elements a file of size_t bytes can hold */
+template<typename T>
+std::size_t MappedArray<T>::max_capacity()
+{
+	return ( std::numeric_limits<std::size_t>::max() - MAPPED_ARRAY_HEADER_SIZE ) / sizeof( T );
+}
+
+
+template<typename T>
+std::size_t MappedArray<T>::file_size( std::size_t capacity )
+{
+	if ( capacity > max_capacity() )
+	{
+		throw std::length_error( "MappedArray capacity is too big" );
+	}
+	return MAPPED_ARRAY_HEADER_SIZE + capacity * sizeof( T );
+}
+
+
+template<typename T>
+MappedArray<T>::MappedArray( const std::string& path, std::size_t capacity ):
+	view( nullptr ),
+	view_size( 0 ),
+	header( nullptr ),
+	a( nullptr )
+{
+	std::size_t existing;
+#ifdef _WIN32
+	mapping = nullptr;
+	file = CreateFileA( path.c_str(), GENERIC_READ | GENERIC_WRITE, 0, nullptr, OPEN_ALWAYS, FILE_ATTRIBUTE_NORMAL, nullptr );
+	if ( file == INVALID_HANDLE_VALUE )
+	{
+		throw std::runtime_error( "cannot open " + path );
+	}
+	LARGE_INTEGER bytes;
+	GetFileSizeEx( file, &bytes );
+	existing = (std::size_t) bytes.QuadPart;
+#else
+	file = ::open( path.c_str(), O_RDWR | O_CREAT, 0644 );
+	if ( file < 0 )
+	{
+		throw std::runtime_error( "cannot open " + path );
+	}
+	struct stat info;
+	fstat( file, &info );
+	existing = (std::size_t) info.st_size;
+#endif
+
+	try
+	{
+		if ( existing > 0 )
+		{
+			/* a foreign file is never resized or overwritten */
+			if ( existing < MAPPED_ARRAY_HEADER_SIZE )
+			{
+				throw std::runtime_error( path + " is not an array of this element type" );
+			}
+			map( existing );
+			if ( header->magic != MAPPED_ARRAY_MAGIC || header->element_size != sizeof( T ) ||
+				header->size > header->capacity || header->capacity > ( existing - MAPPED_ARRAY_HEADER_SIZE ) / sizeof( T ) )
+			{
+				throw std::runtime_error( path + " is not an array of this element type" );
+			}
+			return;
+		}
+		capacity = capacity > 0 ? capacity : DEFAULT_ARRAY_CAPACITY;
+		map( file_size( capacity ) );
+		header->magic = MAPPED_ARRAY_MAGIC;
+		header->element_size = sizeof( T );
+		header->size = 0;
+		header->capacity = capacity;
+	}
+	catch ( ... )
+	{
+		close();
+		throw;
+	}
+}
+
+
+template<typename T>
+MappedArray<T>::~MappedArray()
+{
+	close();
+}
+
+
+template<typename T>
+void MappedArray<T>::close()
+{
+	unmap();
+#ifdef _WIN32
+	CloseHandle( file );
+#else
+	::close( file );
+#endif
+}
+
+
+/* mapping the first bytes of the file, the file is extended if shorter */
+template<typename T>
+void MappedArray<T>::map( std::size_t bytes )
+{
+#ifdef _WIN32
+	mapping = CreateFileMappingA( file, nullptr, PAGE_READWRITE, (DWORD) ( (std::uint64_t) bytes >> 32 ), (DWORD) bytes, nullptr );
+	view = mapping != nullptr ? MapViewOfFile( mapping, FILE_MAP_ALL_ACCESS, 0, 0, bytes ) : nullptr;
+	if ( view == nullptr )
+	{
+		throw std::runtime_error( "cannot map file" );
+	}
+#else
+	if ( ftruncate( file, (off_t) bytes ) != 0 )
+	{
+		throw std::runtime_error( "cannot resize file" );
+	}
+	view = mmap( nullptr, bytes, PROT_READ | PROT_WRITE, MAP_SHARED, file, 0 );
+	if ( view == MAP_FAILED )
+	{
+		view = nullptr;
+		throw std::runtime_error( "cannot map file" );
+	}
+#endif
+	view_size = bytes;
+	header = (Header*) view;
+	a = (T*) ( (char*) view + MAPPED_ARRAY_HEADER_SIZE );
+}
+
+
+template<typename T>
+void MappedArray<T>::unmap()
+{
+	if ( view == nullptr )
+	{
+		return;
+	}
+#ifdef _WIN32
+	UnmapViewOfFile( view );
+	CloseHandle( mapping );
+	mapping = nullptr;
+#else
+	munmap( view, view_size );
+#endif
+	view = nullptr;
+	header = nullptr;
+	a = nullptr;
+}
+
+
+template<typename T>
+void MappedArray<T>::flush()
+{
+#ifdef _WIN32
+	FlushViewOfFile( view, view_size );
+#else
+	msync( view, view_size, MS_SYNC );
+#endif
+}
+
+
+/* doubled capacity, limited by the largest file size */
+template<typename T>
+std::size_t MappedArray<T>::grown_capacity() const
+{
+	std::size_t capacity = (std::size_t) header->capacity;
+	if ( header->size >= max_capacity() )
+	{
+		throw std::length_error( "MappedArray capacity is too big" );
+	}
+	std::size_t doubled = capacity > max_capacity() / 2 ? max_capacity() : capacity * 2;
+	return doubled > 0 ? doubled : DEFAULT_ARRAY_CAPACITY;
+}
+
+
+/* growing the file and remapping it, then 1 element shift from shift_index;
+   if the bigger mapping fails, the old one is restored */
+template<typename T>
+void MappedArray<T>::enlarge_capacity( std::size_t shift_index )
+{
+	std::size_t old_capacity = (std::size_t) header->capacity;
+	std::size_t capacity = grown_capacity();
+	unmap();
+	try
+	{
+		map( file_size( capacity ) );
+	}
+	catch ( ... )
+	{
+		map( file_size( old_capacity ) );
+		throw;
+	}
+	header->capacity = capacity;
+	std::memmove( a + shift_index + 1, a + shift_index, ( header->size - shift_index ) * sizeof( T ) );
+}
+
+
+template<typename T>
+std::size_t MappedArray<T>::insert( const T& value )
+{
+	return insert( length(), value );
+}
+
+
+template<typename T>
+std::size_t MappedArray<T>::insert( std::size_t index, const T& value )
+{
+	T copy = value;
+	if ( header->size == header->capacity )
+	{
+		enlarge_capacity( index );
+	}
+	else
+	{
+		std::memmove( a + index + 1, a + index, ( header->size - index ) * sizeof( T ) );
+	}
+	a[index] = copy;
+	header->size++;
+	return index;
+}
+
+
+template<typename T>
+void MappedArray<T>::remove( std::size_t index )
+{
+	std::memmove( a + index, a + index + 1, ( header->size - index - 1 ) * sizeof( T ) );
+	header->size--;
+}
+
+
+template<typename T>
+const T& MappedArray<T>::operator [] ( std::size_t index ) const
+{
+	return a[index];
+}
+
+
+template<typename T>
+T& MappedArray<T>::operator [] ( std::size_t index )
+{
+	return a[index];
+}
+
+
+template<typename T>
+std::size_t MappedArray<T>::length() const
+{
+	return (std::size_t) header->size;
+}
+
+
+template<typename T>
+T* MappedArray<T>::data()
+{
+	return a;
+}
+
+template<typename T>
+const T* MappedArray<T>::data() const
+{
+	return a;
+}
+
+template<typename T>
+T* MappedArray<T>::begin()
+{
+	return a;
+}
+
+template<typename T>
+T* MappedArray<T>::end()
+{
+	return a + header->size;
+}
+
+template<typename T>
+const T* MappedArray<T>::begin() const
+{
+	return a;
+}
+
+template<typename T>
+const T* MappedArray<T>::end() const
+{
+	return a + header->size;
+}
\ No newline at end of file
@@ -0,0 +1,131 @@
+#pragma once
+
+#include <cstddef>
+#include <cstring>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+/* bulk operations over contiguous ranges split into one chunk per hardware
+   thread; short ranges run on the calling thread, which always takes the
+   last chunk itself */
+
+constexpr std::size_t PARALLEL_MIN_CHUNK_LENGTH = 64 * 1024;
+
+
+/* number of chunks [0, length) is split into */
+inline std::size_t parallel_chunk_count( std::size_t length )
+{
+	std::size_t threads = std::thread::hardware_concurrency();
+	threads = threads > 0 ? threads : 1;
+	std::size_t by_length = length / PARALLEL_MIN_CHUNK_LENGTH;
+	threads = by_length < threads ? by_length : threads;
+	return threads > 0 ? threads : 1;
+}
+
+
+/* f( first, last ) for every chunk [first, last) of [0, length),
+   chunks are of equal length except the last one */
+template<typename Function>
+void parallel_for( std::size_t length, Function f )
+{
+	std::size_t threads = parallel_chunk_count( length );
+	if ( threads == 1 )
+	{
+		f( (std::size_t) 0, length );
+		return;
+	}
+
+	std::vector<std::thread> workers;
+	workers.reserve( threads - 1 );
+	std::size_t chunk = length / threads;
+	for ( std::size_t t = 0; t + 1 < threads; t++ )
+	{
+		workers.emplace_back( f, t * chunk, ( t + 1 ) * chunk );
+	}
+	f( ( threads - 1 ) * chunk, length );
+	for ( auto& worker : workers )
+	{
+		worker.join();
+	}
+}
+
+
+/* assigning value to every element of [first, last) */
+template<typename T>
+void parallel_fill( T* first, T* last, const T& value )
+{
+	parallel_for( (std::size_t) ( last - first ), [=, &value]( std::size_t from, std::size_t to )
+	{
+		for ( std::size_t i = from; i < to; i++ )
+		{
+			first[i] = value;
+		}
+	} );
+}
+
+
+/* assigning [first, last) to the initialized elements starting at out,
+   the ranges must not overlap */
+template<typename T>
+void parallel_copy( const T* first, const T* last, T* out )
+{
+	parallel_for( (std::size_t) ( last - first ), [=]( std::size_t from, std::size_t to )
+	{
+		if constexpr ( std::is_trivially_copyable<T>::value )
+		{
+			std::memcpy( out + from, first + from, ( to - from ) * sizeof( T ) );
+		}
+		else
+		{
+			for ( std::size_t i = from; i < to; i++ )
+			{
+				out[i] = first[i];
+			}
+		}
+	} );
+}
+
+
+/* replacing every element x of [first, last) with f( x ),
+   f is called concurrently and must not have shared state */
+template<typename T, typename Function>
+void parallel_transform( T* first, T* last, Function f )
+{
+	parallel_for( (std::size_t) ( last - first ), [=, &f]( std::size_t from, std::size_t to )
+	{
+		for ( std::size_t i = from; i < to; i++ )
+		{
+			first[i] = f( first[i] );
+		}
+	} );
+}
+
+
+/* op( ... op( op( init, x0 ), x1 ) ... ), chunks are folded separately
+   (all but the first starting from their first element converted to R)
+   and then combined in order, so op must be associative */
+template<typename T, typename R, typename Operation>
+R parallel_reduce( const T* first, const T* last, R init, Operation op )
+{
+	std::size_t length = (std::size_t) ( last - first );
+	std::size_t threads = parallel_chunk_count( length );
+	std::size_t chunk = length / threads;
+	std::vector<R> partial( threads, init );
+	parallel_for( length, [&]( std::size_t from, std::size_t to )
+	{
+		std::size_t k = chunk > 0 ? from / chunk : 0;
+		R result = k == 0 ? init : R( first[from++] );
+		for ( std::size_t i = from; i < to; i++ )
+		{
+			result = op( result, first[i] );
+		}
+		partial[k] = result;
+	} );
+	R result = partial[0];
+	for ( std::size_t k = 1; k < threads; k++ )
+	{
+		result = op( result, partial[k] );
+	}
+	return result;
+}
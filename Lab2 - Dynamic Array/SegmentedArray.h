@@ -0,0 +1,378 @@
+#pragma once
+
+#include <new>
+
+#include "Array.h"
+
+/* segmented array: elements live in fixed-size segments listed in a directory,
+   growth allocates one more segment and never moves existing elements,
+   so references stay valid while elements are only appended */
+
+constexpr std::size_t DEFAULT_SEGMENT_LENGTH = 4096;
+
+template<typename T, std::size_t SEGMENT_LENGTH = DEFAULT_SEGMENT_LENGTH>
+class SegmentedArray final
+{
+	static_assert( SEGMENT_LENGTH > 0 && ( SEGMENT_LENGTH & ( SEGMENT_LENGTH - 1 ) ) == 0,
+		"segment length must be a power of two" );
+
+	public:
+		SegmentedArray();
+		SegmentedArray( std::size_t capacity );
+		SegmentedArray( const SegmentedArray& other );
+		SegmentedArray( SegmentedArray&& other );
+		~SegmentedArray();
+
+		SegmentedArray& operator = ( const SegmentedArray& other );
+		SegmentedArray& operator = ( SegmentedArray&& other );
+
+		std::size_t insert( const T& value );
+		std::size_t insert( T&& value );
+		std::size_t insert( std::size_t index, const T& value );
+		void remove( std::size_t index );
+
+		template<typename... Args>
+		std::size_t emplace_back( Args&&... args );
+
+		const T& operator [] ( std::size_t index ) const;
+		T& operator [] ( std::size_t index );
+		std::size_t length() const;
+
+
+		class Iterator
+		{
+			public:
+				Iterator( SegmentedArray* array, int step );
+				T& get() const;
+				void set( const T& value );
+				void next();
+				bool hasCurrent() const;
+			private:
+				SegmentedArray* array;
+				std::size_t index;
+				int step;
+		};
+
+		Iterator iterator();
+		Iterator reverseIterator();
+
+		class ConstIterator
+		{
+			public:
+				ConstIterator( const SegmentedArray* array, int step );
+				const T& get() const;
+				void next();
+				bool hasCurrent() const;
+			private:
+				const SegmentedArray* array;
+				std::size_t index;
+				int step;
+		};
+
+		ConstIterator iterator() const;
+		ConstIterator reverseIterator() const;
+
+	private:
+		Array<T*> segments;
+		std::size_t size;
+
+		void clear();
+		void add_segment();
+};
+
+
+/* default costructor */
+template<typename T, std::size_t SEGMENT_LENGTH>
+SegmentedArray<T, SEGMENT_LENGTH>::SegmentedArray():
+	size( 0 )
+{}
+
+
+/* with parameter, segments for capacity elements are allocated at once */
+template<typename T, std::size_t SEGMENT_LENGTH>
+SegmentedArray<T, SEGMENT_LENGTH>::SegmentedArray( std::size_t capacity ):
+	segments( capacity / SEGMENT_LENGTH + 1 ),
+	size( 0 )
+{
+	while ( segments.length() * SEGMENT_LENGTH < capacity )
+	{
+		add_segment();
+	}
+}
+
+
+/* copy constructor */
+template<typename T, std::size_t SEGMENT_LENGTH>
+SegmentedArray<T, SEGMENT_LENGTH>::SegmentedArray( const SegmentedArray<T, SEGMENT_LENGTH>& other ):
+	SegmentedArray( other.size )
+{
+	for ( std::size_t i = 0; i < other.size; i++ )
+	{
+		new( &( *this )[i] ) T( other[i] );
+		size++;
+	}
+}
+
+
+/* move constructor */
+template<typename T, std::size_t SEGMENT_LENGTH>
+SegmentedArray<T, SEGMENT_LENGTH>::SegmentedArray( SegmentedArray<T, SEGMENT_LENGTH>&& other ):
+	segments( std::move( other.segments ) ),
+	size( other.size )
+{
+	other.size = 0;
+}
+
+
+/* destructor */
+template<typename T, std::size_t SEGMENT_LENGTH>
+SegmentedArray<T, SEGMENT_LENGTH>::~SegmentedArray()
+{
+	clear();
+}
+
+
+/* copy assignment */
+template<typename T, std::size_t SEGMENT_LENGTH>
+SegmentedArray<T, SEGMENT_LENGTH>& SegmentedArray<T, SEGMENT_LENGTH>::operator = ( const SegmentedArray<T, SEGMENT_LENGTH>& other )
+{
+	if ( this != &other )
+	{
+		SegmentedArray<T, SEGMENT_LENGTH> copy( other );
+		*this = std::move( copy );
+	}
+	return *this;
+}
+
+
+/* move assignment */
+template<typename T, std::size_t SEGMENT_LENGTH>
+SegmentedArray<T, SEGMENT_LENGTH>& SegmentedArray<T, SEGMENT_LENGTH>::operator = ( SegmentedArray<T, SEGMENT_LENGTH>&& other )
+{
+	if ( this != &other )
+	{
+		clear();
+		segments = std::move( other.segments );
+		size = other.size;
+		other.size = 0;
+	}
+	return *this;
+}
+
+
+/* memory freeing, the directory itself is kept */
+template<typename T, std::size_t SEGMENT_LENGTH>
+void SegmentedArray<T, SEGMENT_LENGTH>::clear()
+{
+	if constexpr ( !std::is_trivially_destructible<T>::value )
+	{
+		for ( std::size_t i = 0; i < size; i++ )
+		{
+			( *this )[i].~T();
+		}
+	}
+	for ( std::size_t i = 0; i < segments.length(); i++ )
+	{
+		std::free( segments[i] );
+	}
+	segments.erase( 0, segments.length() );
+	size = 0;
+}
+
+
+template<typename T, std::size_t SEGMENT_LENGTH>
+void SegmentedArray<T, SEGMENT_LENGTH>::add_segment()
+{
+	T* segment = (T*) std::malloc( SEGMENT_LENGTH * sizeof( T ) );
+	if ( segment == nullptr )
+	{
+		throw std::bad_alloc();
+	}
+	try
+	{
+		segments.insert( segment );
+	}
+	catch ( ... )
+	{
+		std::free( segment );
+		throw;
+	}
+}
+
+
+template<typename T, std::size_t SEGMENT_LENGTH>
+std::size_t SegmentedArray<T, SEGMENT_LENGTH>::insert( const T& value )
+{
+	return emplace_back( value );
+}
+
+
+template<typename T, std::size_t SEGMENT_LENGTH>
+std::size_t SegmentedArray<T, SEGMENT_LENGTH>::insert( T&& value )
+{
+	return emplace_back( std::move( value ) );
+}
+
+
+template<typename T, std::size_t SEGMENT_LENGTH>
+template<typename... Args>
+std::size_t SegmentedArray<T, SEGMENT_LENGTH>::emplace_back( Args&&... args )
+{
+	if ( size == segments.length() * SEGMENT_LENGTH )
+	{
+		add_segment();
+	}
+	new( &( *this )[size] ) T( std::forward<Args>( args )... );
+	return size++;
+}
+
+
+/* elements after index are moved one position forward */
+template<typename T, std::size_t SEGMENT_LENGTH>
+std::size_t SegmentedArray<T, SEGMENT_LENGTH>::insert( std::size_t index, const T& value )
+{
+	if ( index == size )
+	{
+		return emplace_back( value );
+	}
+	/* value may be an element of the array itself */
+	T copy( value );
+	emplace_back( std::move( ( *this )[size - 1] ) );
+	for ( std::size_t i = size - 2; i > index; i-- )
+	{
+		( *this )[i] = std::move( ( *this )[i - 1] );
+	}
+	( *this )[index] = std::move( copy );
+	return index;
+}
+
+
+/* the last segment is kept as a spare when it becomes empty */
+template<typename T, std::size_t SEGMENT_LENGTH>
+void SegmentedArray<T, SEGMENT_LENGTH>::remove( std::size_t index )
+{
+	for ( std::size_t i = index + 1; i < size; i++ )
+	{
+		( *this )[i - 1] = std::move( ( *this )[i] );
+	}
+	size--;
+	( *this )[size].~T();
+	if ( segments.length() >= 2 && ( segments.length() - 2 ) * SEGMENT_LENGTH >= size )
+	{
+		std::free( segments[segments.length() - 1] );
+		segments.remove( segments.length() - 1 );
+	}
+}
+
+
+template<typename T, std::size_t SEGMENT_LENGTH>
+const T& SegmentedArray<T, SEGMENT_LENGTH>::operator [] ( std::size_t index ) const
+{
+	return segments[index / SEGMENT_LENGTH][index & ( SEGMENT_LENGTH - 1 )];
+}
+
+
+template<typename T, std::size_t SEGMENT_LENGTH>
+T& SegmentedArray<T, SEGMENT_LENGTH>::operator [] ( std::size_t index )
+{
+	return segments[index / SEGMENT_LENGTH][index & ( SEGMENT_LENGTH - 1 )];
+}
+
+
+template<typename T, std::size_t SEGMENT_LENGTH>
+std::size_t SegmentedArray<T, SEGMENT_LENGTH>::length() const
+{
+	return size;
+}
+
+
+
+/* iterators */
+
+
+template<typename T, std::size_t SEGMENT_LENGTH>
+SegmentedArray<T, SEGMENT_LENGTH>::Iterator::Iterator( SegmentedArray<T, SEGMENT_LENGTH>* array, int step ):
+	array( array ),
+	index( step > 0 ? 0 : ( array->length() - 1 ) ),
+	step( step )
+{}
+
+template<typename T, std::size_t SEGMENT_LENGTH>
+void SegmentedArray<T, SEGMENT_LENGTH>::Iterator::next()
+{
+	index += step;
+}
+
+template<typename T, std::size_t SEGMENT_LENGTH>
+bool SegmentedArray<T, SEGMENT_LENGTH>::Iterator::hasCurrent() const
+{
+	return index < array->length();
+}
+
+template<typename T, std::size_t SEGMENT_LENGTH>
+T& SegmentedArray<T, SEGMENT_LENGTH>::Iterator::get() const
+{
+	return ( *array )[index];
+}
+
+template<typename T, std::size_t SEGMENT_LENGTH>
+void SegmentedArray<T, SEGMENT_LENGTH>::Iterator::set( const T& value )
+{
+	( *array )[index] = value;
+}
+
+
+template<typename T, std::size_t SEGMENT_LENGTH>
+SegmentedArray<T, SEGMENT_LENGTH>::ConstIterator::ConstIterator( const SegmentedArray<T, SEGMENT_LENGTH>* array, int step ):
+	array( array ),
+	index( step > 0 ? 0 : ( array->length() - 1 ) ),
+	step( step )
+{}
+
+template<typename T, std::size_t SEGMENT_LENGTH>
+void SegmentedArray<T, SEGMENT_LENGTH>::ConstIterator::next()
+{
+	index += step;
+}
+
+template<typename T, std::size_t SEGMENT_LENGTH>
+bool SegmentedArray<T, SEGMENT_LENGTH>::ConstIterator::hasCurrent() const
+{
+	return index < array->length();
+}
+
+template<typename T, std::size_t SEGMENT_LENGTH>
+const T& SegmentedArray<T, SEGMENT_LENGTH>::ConstIterator::get() const
+{
+	return ( *array )[index];
+}
+
+
+
+template<typename T, std::size_t SEGMENT_LENGTH>
+typename SegmentedArray<T, SEGMENT_LENGTH>::Iterator SegmentedArray<T, SEGMENT_LENGTH>::iterator()
+{
+	SegmentedArray<T, SEGMENT_LENGTH>::Iterator iterator( this, 1 );
+	return iterator;
+}
+
+template<typename T, std::size_t SEGMENT_LENGTH>
+typename SegmentedArray<T, SEGMENT_LENGTH>::ConstIterator SegmentedArray<T, SEGMENT_LENGTH>::iterator() const
+{
+	SegmentedArray<T, SEGMENT_LENGTH>::ConstIterator iterator( this, 1 );
+	return iterator;
+}
+
+template<typename T, std::size_t SEGMENT_LENGTH>
+typename SegmentedArray<T, SEGMENT_LENGTH>::Iterator SegmentedArray<T, SEGMENT_LENGTH>::reverseIterator()
+{
+	SegmentedArray<T, SEGMENT_LENGTH>::Iterator iterator( this, -1 );
+	return iterator;
+}
+
+template<typename T, std::size_t SEGMENT_LENGTH>
+typename SegmentedArray<T, SEGMENT_LENGTH>::ConstIterator SegmentedArray<T, SEGMENT_LENGTH>::reverseIterator() const
+{
+	SegmentedArray<T, SEGMENT_LENGTH>::ConstIterator iterator( this, -1 );
+	return iterator;
+}
\ No newline at end of file
@@ -0,0 +1,146 @@
+#pragma once
+
+#include <tuple>
+#include <utility>
+
+#include "Array.h"
+#include "View.h"
+
+/* structure of arrays: records of Fields... stored as one contiguous column
+   per field, so a scan over one field touches only that field's memory;
+   column<I>() is a Slice of one column, valid until the next insert or remove */
+
+template<typename... Fields>
+class SoaArray final
+{
+	public:
+		SoaArray();
+		SoaArray( std::size_t capacity );
+
+		std::size_t insert( const Fields&... values );
+		std::size_t insert( std::size_t index, const Fields&... values );
+		void remove( std::size_t index );
+
+		/* one record as a tuple of references to its fields */
+		std::tuple<Fields&...> operator [] ( std::size_t index );
+		std::tuple<const Fields&...> operator [] ( std::size_t index ) const;
+		std::size_t length() const;
+
+		template<int I>
+		Slice<std::tuple_element_t<I, std::tuple<Fields...>>> column();
+		template<int I>
+		Slice<const std::tuple_element_t<I, std::tuple<Fields...>>> column() const;
+
+	private:
+		std::tuple<Array<Fields>...> columns;
+
+		template<std::size_t... I>
+		std::tuple<Array<Fields>...> make_columns( std::size_t capacity, std::index_sequence<I...> );
+};
+
+
+template<typename... Fields>
+SoaArray<Fields...>::SoaArray()
+{}
+
+
+template<typename... Fields>
+SoaArray<Fields...>::SoaArray( std::size_t capacity ):
+	columns( make_columns( capacity, std::index_sequence_for<Fields...>() ) )
+{}
+
+
+template<typename... Fields>
+template<std::size_t... I>
+std::tuple<Array<Fields>...> SoaArray<Fields...>::make_columns( std::size_t capacity, std::index_sequence<I...> )
+{
+	return std::tuple<Array<Fields>...>( ( (void) I, capacity )... );
+}
+
+
+template<typename... Fields>
+std::size_t SoaArray<Fields...>::insert( const Fields&... values )
+{
+	return insert( length(), values... );
+}
+
+
+template<typename... Fields>
+std::size_t SoaArray<Fields...>::insert( std::size_t index, const Fields&... values )
+{
+	/* columns already holding the new record lose it again if a later one
+	   throws, so all columns keep the same length */
+	std::size_t inserted = 0;
+	try
+	{
+		std::apply( [&]( Array<Fields>&... column )
+		{
+			( ( column.insert( index, values ), inserted++ ), ... );
+		}, columns );
+	}
+	catch ( ... )
+	{
+		std::apply( [&]( Array<Fields>&... column )
+		{
+			std::size_t i = 0;
+			( ( i++ < inserted ? column.remove( index ) : (void) 0 ), ... );
+		}, columns );
+		throw;
+	}
+	return index;
+}
+
+
+template<typename... Fields>
+void SoaArray<Fields...>::remove( std::size_t index )
+{
+	std::apply( [index]( Array<Fields>&... column )
+	{
+		( column.remove( index ), ... );
+	}, columns );
+}
+
+
+template<typename... Fields>
+std::tuple<Fields&...> SoaArray<Fields...>::operator [] ( std::size_t index )
+{
+	return std::apply( [index]( Array<Fields>&... column )
+	{
+		return std::tuple<Fields&...>( column[index]... );
+	}, columns );
+}
+
+
+template<typename... Fields>
+std::tuple<const Fields&...> SoaArray<Fields...>::operator [] ( std::size_t index ) const
+{
+	return std::apply( [index]( const Array<Fields>&... column )
+	{
+		return std::tuple<const Fields&...>( column[index]... );
+	}, columns );
+}
+
+
+template<typename... Fields>
+std::size_t SoaArray<Fields...>::length() const
+{
+	return std::get<0>( columns ).length();
+}
+
+
+template<typename... Fields>
+template<int I>
+Slice<std::tuple_element_t<I, std::tuple<Fields...>>> SoaArray<Fields...>::column()
+{
+	auto& column = std::get<I>( columns );
+	return Slice<std::tuple_element_t<I, std::tuple<Fields...>>>( column.data(), column.length() );
+}
+
+
+template<typename... Fields>
+template<int I>
+Slice<const std::tuple_element_t<I, std::tuple<Fields...>>> SoaArray<Fields...>::column() const
+{
+	const auto& column = std::get<I>( columns );
+	return Slice<const std::tuple_element_t<I, std::tuple<Fields...>>>( column.data(), column.length() );
+}
\ No newline at end of file
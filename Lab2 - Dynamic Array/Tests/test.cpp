@@ -1,6 +1,28 @@
 #include "pch.h"
 
+#include <algorithm>
+#include <cstdio>
+#include <functional>
+#include <limits>
+#include <map>
+#include <set>
+#include <stdexcept>
+#include <numeric>
+#include <random>
+#include <thread>
+#include <vector>
+
 #include "../Array.h"
+#include "../ConcurrentArray.h"
+#include "../CowArray.h"
+#include "../FlatMap.h"
+#include "../GapArray.h"
+#include "../Heap.h"
+#include "../MappedArray.h"
+#include "../SegmentedArray.h"
+#include "../SoaArray.h"
+#include "../TieredArray.h"
+#include "../View.h"
 
 
 TEST( ArrayTest, DefaultConstructor )
@@ -111,7 +133,7 @@ TEST( ArrayTest, CopyConstructor )
     Array<int> X( A );
 
     EXPECT_EQ( A.length(), X.length() );
-    for ( int i = 0; i < A.length(); i++ )
+    for ( std::size_t i = 0; i < A.length(); i++ )
     {
         EXPECT_EQ( A[i], X[i] );
     }
@@ -124,13 +146,85 @@ TEST( ArrayTest, CopyConstructor )
     Array<std::string> Y( B );
  
     EXPECT_EQ( B.length(), Y.length() );
-    for ( int i = 0; i < Y.length(); i++ )
+    for ( std::size_t i = 0; i < Y.length(); i++ )
     {
         EXPECT_EQ( B[i], Y[i] );
     }
 }
 
 
+/* copy constructor throwing on the copy_limit-th copy */
+struct ThrowingCopy
+{
+    static int copies;
+    static int copy_limit;
+    static int alive;
+
+    int value;
+
+    ThrowingCopy( int value ): value( value ) { alive++; }
+    ThrowingCopy( const ThrowingCopy& other ): value( other.value )
+    {
+        if ( ++copies == copy_limit )
+            throw std::runtime_error( "copy failed" );
+        alive++;
+    }
+    ~ThrowingCopy() { alive--; }
+};
+
+int ThrowingCopy::copies = 0;
+int ThrowingCopy::copy_limit = 0;
+int ThrowingCopy::alive = 0;
+
+
+/* default constructor throwing while fail is set, copies of negative values throw */
+struct PickyValue
+{
+    static bool fail;
+
+    int value;
+
+    PickyValue(): value( 0 )
+    {
+        if ( fail )
+            throw std::runtime_error( "construction failed" );
+    }
+    PickyValue( int value ): value( value ) {}
+    PickyValue( const PickyValue& other ): value( other.value )
+    {
+        if ( value < 0 )
+            throw std::runtime_error( "copy failed" );
+    }
+    PickyValue( PickyValue&& other ) noexcept: value( other.value ) {}
+    PickyValue& operator = ( PickyValue&& other ) noexcept { value = other.value; return *this; }
+};
+
+bool PickyValue::fail = false;
+
+
+TEST( ArrayTest, CopyConstructorThrows )
+{
+    {
+        Array<ThrowingCopy> A;
+        for ( int i = 0; i < 20; i++ )
+            A.emplace_back( i );
+        ThrowingCopy::copies = 0;
+        ThrowingCopy::copy_limit = 10;
+        EXPECT_THROW( Array<ThrowingCopy> B( A ), std::runtime_error );
+        EXPECT_EQ( ThrowingCopy::alive, 20 );
+
+        Array<ThrowingCopy> C;
+        C.emplace_back( -1 );
+        ThrowingCopy::copies = 0;
+        EXPECT_THROW( C = A, std::runtime_error );
+        EXPECT_EQ( C.length(), 1 );
+        EXPECT_EQ( C[0].value, -1 );
+        EXPECT_EQ( ThrowingCopy::alive, 21 );
+    }
+    EXPECT_EQ( ThrowingCopy::alive, 0 );
+}
+
+
 TEST( ArrayTest, MoveConstructor )
 {
     Array<int> A;
@@ -142,7 +236,7 @@ TEST( ArrayTest, MoveConstructor )
     Array<int> X( std::move( CopyA ) );
 
     EXPECT_EQ( A.length(), X.length() );
-    for ( int i = 0; i < A.length(); i++ )
+    for ( std::size_t i = 0; i < A.length(); i++ )
     {
         EXPECT_EQ( A[i], X[i] );
     }
@@ -156,7 +250,7 @@ TEST( ArrayTest, MoveConstructor )
     Array<std::string> Y( std::move( CopyB ) );
 
     EXPECT_EQ( B.length(), Y.length() );
-    for ( int i = 0; i < Y.length(); i++ )
+    for ( std::size_t i = 0; i < Y.length(); i++ )
     {
         EXPECT_EQ( B[i], Y[i] );
     }
@@ -174,7 +268,7 @@ TEST( ArrayTest, CopyAssignment )
     X = A;
     
     EXPECT_EQ( A.length(), X.length() );
-    for ( int i = 0; i < A.length(); i++ )
+    for ( std::size_t i = 0; i < A.length(); i++ )
     {
         EXPECT_EQ( A[i], X[i] );
     }
@@ -188,7 +282,7 @@ TEST( ArrayTest, CopyAssignment )
     Y = B;
    
     EXPECT_EQ( B.length(), Y.length() );
-    for ( int i = 0; i < Y.length(); i++ )
+    for ( std::size_t i = 0; i < Y.length(); i++ )
     {
         EXPECT_EQ( B[i], Y[i] );
     }
@@ -207,7 +301,7 @@ TEST( ArrayTest, MoveAssignment )
     X = std::move( CopyA );
 
     EXPECT_EQ( A.length(), X.length() );
-    for ( int i = 0; i < A.length(); i++ )
+    for ( std::size_t i = 0; i < A.length(); i++ )
     {
         EXPECT_EQ( A[i], X[i] );
     }
@@ -222,7 +316,7 @@ TEST( ArrayTest, MoveAssignment )
     Y = std::move( CopyB );
 
     EXPECT_EQ( B.length(), Y.length() );
-    for ( int i = 0; i < Y.length(); i++ )
+    for ( std::size_t i = 0; i < Y.length(); i++ )
     {
         EXPECT_EQ( B[i], Y[i] );
     }
@@ -280,4 +374,975 @@ TEST( ArrayTest, ReverseIterator )
         i--;
         EXPECT_EQ( it.get(), std::to_string( i ) ); 
     }
+}
+
+struct Point
+{
+    int x;
+    double y;
+};
+
+
+TEST( ArrayTest, TriviallyRelocatable )
+{
+    Array<Point> A( 1 );
+    std::vector<Point> V;
+    for ( int i = 0; i < 1000; i++ )
+    {
+        A.insert( A.length() / 2, Point{ i, i * 0.5 } );
+        V.insert( V.begin() + V.size() / 2, Point{ i, i * 0.5 } );
+    }
+    A.remove( 500 );
+    V.erase( V.begin() + 500 );
+    A.remove( 0 );
+    V.erase( V.begin() );
+
+    EXPECT_EQ( A.length(), 998 );
+    for ( std::size_t i = 0; i < A.length(); i++ )
+    {
+        EXPECT_EQ( A[i].x, V[i].x );
+        EXPECT_EQ( A[i].y, V[i].y );
+    }
+
+    Array<Point> X( A );
+    EXPECT_EQ( A.length(), X.length() );
+    for ( std::size_t i = 0; i < A.length(); i++ )
+    {
+        EXPECT_EQ( A[i].x, X[i].x );
+    }
+
+    Array<std::string> B( 1 );
+    std::vector<std::string> W;
+    for ( int i = 0; i < 100; i++ )
+    {
+        B.insert( B.length() / 2, std::to_string( i ) );
+        W.insert( W.begin() + W.size() / 2, std::to_string( i ) );
+    }
+    B.remove( 50 );
+    W.erase( W.begin() + 50 );
+
+    EXPECT_EQ( B.length(), 99 );
+    for ( std::size_t i = 0; i < B.length(); i++ )
+    {
+        EXPECT_EQ( B[i], W[i] );
+    }
+}
+
+TEST( ArrayTest, InlineStorage )
+{
+    Array<std::string, 4> A;
+    A.insert( "0" );
+    A.insert( "1" );
+    A.insert( "2" );
+
+    Array<std::string, 4> X( A );
+    Array<std::string, 4> Y( std::move( X ) );
+    EXPECT_EQ( X.length(), 0 );
+    EXPECT_EQ( Y.length(), 3 );
+    EXPECT_EQ( Y[2], "2" );
+    X.insert( "reused" );
+    EXPECT_EQ( X[0], "reused" );
+
+    for ( int i = 3; i < 100; i++ )
+        A.insert( 0, std::to_string( i ) );
+    EXPECT_EQ( A.length(), 100 );
+    EXPECT_EQ( A[0], "99" );
+    EXPECT_EQ( A[99], "2" );
+
+    Y = A;
+    EXPECT_EQ( Y.length(), 100 );
+    EXPECT_EQ( Y[50], A[50] );
+    A = std::move( X );
+    EXPECT_EQ( A.length(), 1 );
+    EXPECT_EQ( A[0], "reused" );
+    Y = std::move( A );
+    EXPECT_EQ( Y.length(), 1 );
+    EXPECT_EQ( Y[0], "reused" );
+
+    Array<int, 8> B;
+    for ( int i = 0; i < 8; i++ )
+        B.insert( i );
+    B.remove( 0 );
+    B.insert( 3, 42 );
+    B.insert( 42 );
+    EXPECT_EQ( B.length(), 9 );
+    EXPECT_EQ( B[3], 42 );
+    EXPECT_EQ( B[8], 42 );
+    EXPECT_EQ( B[7], 7 );
+}
+
+
+TEST( ArrayTest, Emplace )
+{
+    Array<std::string> A;
+    std::string s = "moved";
+    EXPECT_EQ( A.insert( std::move( s ) ), 0 );
+    EXPECT_EQ( A.emplace_back( 3, 'x' ), 1 );
+    EXPECT_EQ( A.emplace( 1, "middle" ), 1 );
+    std::string t = "first";
+    EXPECT_EQ( A.insert( 0, std::move( t ) ), 0 );
+    EXPECT_EQ( A.length(), 4 );
+    EXPECT_EQ( A[0], "first" );
+    EXPECT_EQ( A[1], "moved" );
+    EXPECT_EQ( A[2], "middle" );
+    EXPECT_EQ( A[3], "xxx" );
+
+    Array<std::pair<int, std::string>> B( 1 );
+    for ( int i = 0; i < 20; i++ )
+        B.emplace( 0, i, std::to_string( i ) );
+    EXPECT_EQ( B.length(), 20 );
+    EXPECT_EQ( B[0].first, 19 );
+    EXPECT_EQ( B[19].second, "0" );
+
+    // the argument may be an element that the shift moves
+    A.insert( 0, A[3] );
+    EXPECT_EQ( A[0], "xxx" );
+    EXPECT_EQ( A[4], "xxx" );
+
+    // a throwing constructor leaves the array as it was
+    Array<PickyValue> C;
+    for ( int i = 0; i < 5; i++ )
+        C.emplace_back( i );
+    PickyValue bad( -1 );
+    EXPECT_THROW( C.insert( 2, bad ), std::runtime_error );
+    EXPECT_EQ( C.length(), 5u );
+    for ( int i = 0; i < 5; i++ )
+        EXPECT_EQ( C[i].value, i );
+}
+
+
+TEST( ArrayTest, InsertRange )
+{
+    int values[] = { 10, 20, 30 };
+    Array<int> A;
+    A.insert( 0 );
+    A.insert( 1 );
+    EXPECT_EQ( A.insert( 1, values, values + 3 ), 1 );
+    EXPECT_EQ( A.append( values, values + 2 ), 5 );
+    EXPECT_EQ( A.length(), 7 );
+    int expected[] = { 0, 10, 20, 30, 1, 10, 20 };
+    for ( int i = 0; i < 7; i++ )
+        EXPECT_EQ( A[i], expected[i] );
+
+    A.insert( 0, A );
+    EXPECT_EQ( A.length(), 14 );
+    for ( int i = 0; i < 7; i++ )
+    {
+        EXPECT_EQ( A[i], expected[i] );
+        EXPECT_EQ( A[i + 7], expected[i] );
+    }
+
+    Array<std::string, 2> B;
+    B.insert( "a" );
+    B.insert( "d" );
+    Array<std::string> C;
+    C.insert( "b" );
+    C.insert( "c" );
+    B.insert( 1, C );
+    B.append( C );
+    EXPECT_EQ( B.length(), 6 );
+    EXPECT_EQ( B[0], "a" );
+    EXPECT_EQ( B[1], "b" );
+    EXPECT_EQ( B[3], "d" );
+    EXPECT_EQ( B[5], "c" );
+}
+
+
+TEST( ArrayTest, ReserveAndShrink )
+{
+    Array<std::string, 4> A;
+    A.reserve( 1000 );
+    for ( int i = 0; i < 1000; i++ )
+        A.insert( std::to_string( i ) );
+    for ( int i = 999; i >= 3; i-- )
+        A.remove( i );
+    A.shrink_to_fit();
+    EXPECT_EQ( A.length(), 3 );
+    EXPECT_EQ( A[2], "2" );
+    A.insert( "3" );
+    A.insert( "4" );
+    EXPECT_EQ( A[4], "4" );
+
+    Array<int> B;
+    B.reserve( 100 );
+    for ( int i = 0; i < 10; i++ )
+        B.insert( i );
+    B.shrink_to_fit();
+    B.insert( 10 );
+    EXPECT_EQ( B.length(), 11 );
+    EXPECT_EQ( B[10], 10 );
+}
+
+
+TEST( ArrayTest, ArenaAllocator )
+{
+    Arena arena( 1024 );
+    {
+        Array<int, 0, ArenaAllocator> A( arena );
+        for ( int i = 0; i < 10000; i++ )
+            A.insert( i );
+        A.insert( 0, -1 );
+        EXPECT_EQ( A.length(), 10001 );
+        EXPECT_EQ( A[0], -1 );
+        EXPECT_EQ( A[10000], 9999 );
+
+        Array<std::string, 2, ArenaAllocator> B( 4, arena );
+        for ( int i = 0; i < 100; i++ )
+            B.insert( std::to_string( i ) );
+        Array<std::string, 2, ArenaAllocator> C( B );
+        B.remove( 0 );
+        EXPECT_EQ( B[0], "1" );
+        EXPECT_EQ( C[0], "0" );
+        EXPECT_EQ( C.length(), 100 );
+
+        Array<int, 0, ArenaAllocator> D( std::move( A ) );
+        EXPECT_EQ( D.length(), 10001 );
+        EXPECT_EQ( D[10000], 9999 );
+        Array<int, 0, ArenaAllocator> E( arena );
+        E.insert( 1 );
+        E = std::move( D );
+        EXPECT_EQ( E.length(), 10001 );
+        EXPECT_EQ( E[0], -1 );
+        Array<std::string, 2, ArenaAllocator> F( std::move( C ) );
+        EXPECT_EQ( F.length(), 100 );
+        EXPECT_EQ( F[99], "99" );
+    }
+    arena.release();
+
+    std::pmr::monotonic_buffer_resource resource;
+    Array<std::string, 0, PmrAllocator> D( PmrAllocator{ &resource } );
+    for ( int i = 0; i < 100; i++ )
+        D.insert( 0, std::to_string( i ) );
+    EXPECT_EQ( D[0], "99" );
+    EXPECT_EQ( D[99], "0" );
+}
+
+
+
+TEST( ArrayTest, StlIterators )
+{
+    Array<int> A;
+    for ( int i = 0; i < 100; i++ )
+        A.insert( ( i * 37 ) % 100 );
+    std::sort( A.begin(), A.end() );
+    int i = 0;
+    for ( int x : A )
+    {
+        EXPECT_EQ( x, i );
+        i++;
+    }
+    EXPECT_EQ( std::accumulate( A.begin(), A.end(), 0 ), 4950 );
+
+    const Array<int>& C = A;
+    EXPECT_EQ( *C.rbegin(), 99 );
+    EXPECT_EQ( C.rend() - C.rbegin(), 100 );
+    EXPECT_EQ( C.end() - C.begin(), 100 );
+
+    i = 10;
+    for ( auto it = C.reverseIterator(); it.hasCurrent(); it.next() )
+        i--;
+    EXPECT_EQ( i, -90 );
+
+    Array<std::string> B;
+    B.insert( "b" );
+    B.insert( "c" );
+    B.insert( "a" );
+    std::sort( B.rbegin(), B.rend() );
+    EXPECT_EQ( B[0], "c" );
+    EXPECT_EQ( B[2], "a" );
+}
+
+
+
+TEST( ArrayTest, Erase )
+{
+    Array<int> A;
+    for ( int i = 0; i < 10; i++ )
+        A.insert( i );
+    A.erase( 2, 5 );
+    EXPECT_EQ( A.length(), 7 );
+    EXPECT_EQ( A[1], 1 );
+    EXPECT_EQ( A[2], 5 );
+    A.erase( 3, 3 );
+    EXPECT_EQ( A.length(), 7 );
+    EXPECT_EQ( A.erase_if( []( int x ) { return x % 2 == 0; } ), 3 );
+    int expected[] = { 1, 5, 7, 9 };
+    EXPECT_EQ( A.length(), 4 );
+    for ( int i = 0; i < 4; i++ )
+        EXPECT_EQ( A[i], expected[i] );
+
+    Array<std::string> B;
+    for ( int i = 0; i < 1000; i++ )
+        B.insert( std::to_string( i ) );
+    EXPECT_EQ( B.erase_if( []( const std::string& s ) { return s.back() != '7'; } ), 900 );
+    EXPECT_EQ( B.length(), 100 );
+    for ( std::size_t i = 0; i < B.length(); i++ )
+        EXPECT_EQ( B[i], std::to_string( i * 10 + 7 ) );
+    B.erase( 0, B.length() );
+    EXPECT_EQ( B.length(), 0 );
+}
+
+
+TEST( ArrayTest, HugePageAllocator )
+{
+    Array<int, 0, HugePageAllocator> A;
+    for ( int i = 0; i < 2000000; i++ )
+        A.insert( i );
+    A.insert( 0, -1 );
+    EXPECT_EQ( A.length(), 2000001u );
+    EXPECT_EQ( A[0], -1 );
+    EXPECT_EQ( A[2000000], 1999999 );
+    A.shrink_to_fit();
+    EXPECT_EQ( A[1000000], 999999 );
+}
+
+
+TEST( ArrayTest, CapacityOverflow )
+{
+    Array<int> A;
+    A.insert( 1 );
+    EXPECT_THROW( A.reserve( std::numeric_limits<std::size_t>::max() / 2 ), std::length_error );
+    Array<std::string> B;
+    EXPECT_THROW( B.reserve( std::numeric_limits<std::size_t>::max() / 4 ), std::length_error );
+    EXPECT_EQ( A[0], 1 );
+    EXPECT_EQ( A.length(), 1u );
+}
+
+
+#ifdef ARRAY_INSTRUMENTATION
+TEST( ArrayTest, Instrumentation )
+{
+    reset_array_stats();
+    {
+        Array<int> A( 4 );
+        for ( int i = 0; i < 5; i++ )
+            A.insert( i );
+        A.insert( 0, -1 );
+        A.remove( 1 );
+        Array<int> B( A );
+
+        const ArrayStats& s = A.stats();
+        EXPECT_EQ( s.allocations, 1u );
+        EXPECT_EQ( s.reallocations, 1u );
+        EXPECT_EQ( s.shifts, 2u );
+        EXPECT_EQ( s.shifted_elements, 9u );
+        EXPECT_EQ( s.longest_shift, 5u );
+        EXPECT_EQ( s.peak_length, 6u );
+        EXPECT_EQ( s.live_bytes, 8 * sizeof( int ) );
+        EXPECT_EQ( B.stats().copied_elements, 5u );
+
+        Array<int> C( std::move( A ) );
+        EXPECT_EQ( C.stats().live_bytes, 8 * sizeof( int ) );
+        EXPECT_EQ( array_stats().live_bytes, 13 * sizeof( int ) );
+    }
+    ArrayStats g = array_stats();
+    EXPECT_EQ( g.live_bytes, 0u );
+    EXPECT_EQ( g.allocations, g.deallocations );
+    EXPECT_EQ( g.peak_length, 6u );
+}
+#endif
+
+
+TEST( ParallelTest, BulkOperations )
+{
+    const std::size_t length = PARALLEL_COPY_BYTES / sizeof( long long ) + 7;
+    Array<long long> A( length );
+    for ( std::size_t i = 0; i < length; i++ )
+        A.insert( (long long) i );
+
+    Array<long long> B( A );
+    EXPECT_TRUE( std::equal( A.begin(), A.end(), B.begin(), B.end() ) );
+
+    parallel_transform( B.begin(), B.end(), []( long long x ) { return x * 2; } );
+    EXPECT_EQ( B[length - 1], 2 * (long long) ( length - 1 ) );
+    long long sum = parallel_reduce( B.begin(), B.end(), 1LL, []( long long x, long long y ) { return x + y; } );
+    EXPECT_EQ( sum, 1 + (long long) length * (long long) ( length - 1 ) );
+
+    parallel_fill( B.begin(), B.end(), -1LL );
+    EXPECT_EQ( std::count( B.begin(), B.end(), -1LL ), (std::ptrdiff_t) length );
+    parallel_copy( A.begin(), A.end(), B.begin() );
+    EXPECT_TRUE( std::equal( A.begin(), A.end(), B.begin(), B.end() ) );
+
+    Array<std::string> S;
+    EXPECT_EQ( parallel_reduce( S.begin(), S.end(), std::string( "x" ), std::plus<std::string>() ), "x" );
+}
+
+
+TEST( CowArrayTest, Snapshots )
+{
+    CowArray<std::string> A;
+    for ( int i = 0; i < 10; i++ )
+        A.insert( std::to_string( i ) );
+
+    CowArray<std::string> snapshot( A );
+    const CowArray<std::string>& reader = snapshot;
+    EXPECT_TRUE( A.is_shared() );
+    EXPECT_EQ( reader.begin(), A.array().begin() );
+    EXPECT_EQ( reader[5], "5" );
+
+    A.insert( 0, "new" );
+    A.remove( 5 );
+    A[1] = "changed";
+    EXPECT_FALSE( A.is_shared() );
+    EXPECT_FALSE( snapshot.is_shared() );
+    EXPECT_EQ( A.length(), 10u );
+    EXPECT_EQ( A[0], "new" );
+    EXPECT_EQ( A[1], "changed" );
+    for ( std::size_t i = 0; i < reader.length(); i++ )
+        EXPECT_EQ( reader[i], std::to_string( i ) );
+
+    CowArray<std::string> moved( std::move( snapshot ) );
+    snapshot = A;
+    EXPECT_EQ( snapshot[0], "new" );
+    snapshot[0] = "own";
+    EXPECT_EQ( A[0], "new" );
+    EXPECT_EQ( moved[0], "0" );
+
+    // a writable reference handed out keeps later copies apart
+    std::string& first = A[0];
+    CowArray<std::string> B( A );
+    EXPECT_FALSE( A.is_shared() );
+    first = "written";
+    const CowArray<std::string>& b = B;
+    EXPECT_EQ( b[0], "new" );
+    A.insert( "last" );
+    CowArray<std::string> C( A );
+    EXPECT_TRUE( A.is_shared() );
+}
+
+
+TEST( FlatMapTest, AgainstStd )
+{
+    std::default_random_engine RandomEngine( 7 );
+    std::uniform_int_distribution<int> RandomKey( 0, 500 );
+
+    Array<int> unsorted;
+    for ( int i = 0; i < 300; i++ )
+        unsorted.insert( RandomKey( RandomEngine ) );
+    FlatSet<int> S( unsorted.begin(), unsorted.end() );
+    std::set<int> reference( unsorted.begin(), unsorted.end() );
+    for ( int round = 0; round < 20; round++ )
+    {
+        int batch[25];
+        for ( int& key : batch )
+            key = RandomKey( RandomEngine );
+        std::size_t before = reference.size();
+        reference.insert( batch, batch + 25 );
+        EXPECT_EQ( S.insert( batch, batch + 25 ), reference.size() - before );
+        int key = RandomKey( RandomEngine );
+        EXPECT_EQ( S.insert( key ), reference.insert( key ).second );
+        key = RandomKey( RandomEngine );
+        EXPECT_EQ( S.remove( key ), reference.erase( key ) == 1 );
+    }
+    EXPECT_TRUE( std::equal( S.begin(), S.end(), reference.begin(), reference.end() ) );
+    for ( int key = -1; key <= 501; key++ )
+        EXPECT_EQ( S.contains( key ), reference.count( key ) == 1 );
+
+    std::pair<std::string, int> pairs[] = { { "b", 1 }, { "a", 2 }, { "b", 3 }, { "c", 4 } };
+    FlatMap<std::string, int> M( pairs, pairs + 4 );
+    EXPECT_EQ( M.length(), 3u );
+    EXPECT_EQ( *M.find( "b" ), 1 );
+    EXPECT_EQ( M.find( "z" ), nullptr );
+    std::pair<std::string, int> more[] = { { "d", 5 }, { "a", 6 }, { "0", 7 } };
+    EXPECT_EQ( M.insert( more, more + 3 ), 2u );
+    EXPECT_FALSE( M.insert( "c", 8 ) );
+    M["e"] = 9;
+    M["a"] += 10;
+    EXPECT_TRUE( M.remove( "d" ) );
+    const char* keys[] = { "0", "a", "b", "c", "e" };
+    int values[] = { 7, 12, 1, 4, 9 };
+    ASSERT_EQ( M.length(), 5u );
+    for ( std::size_t i = 0; i < M.length(); i++ )
+    {
+        EXPECT_EQ( M.key( i ), keys[i] );
+        EXPECT_EQ( M.value( i ), values[i] );
+    }
+}
+
+
+TEST( FlatMapTest, ThrowingValue )
+{
+    FlatMap<int, PickyValue> M;
+    for ( int i = 0; i < 10; i++ )
+        M[i * 2].value = i;
+
+    PickyValue::fail = true;
+    EXPECT_THROW( M[5], std::runtime_error );
+    PickyValue::fail = false;
+    EXPECT_THROW( M.insert( 7, PickyValue( -1 ) ), std::runtime_error );
+
+    // neither key stayed without its value
+    EXPECT_EQ( M.length(), 10u );
+    EXPECT_EQ( M.find( 5 ), nullptr );
+    EXPECT_EQ( M.find( 7 ), nullptr );
+    for ( int i = 0; i < 10; i++ )
+        EXPECT_EQ( M.find( i * 2 )->value, i );
+}
+
+
+TEST( HeapTest, PushPopDecreaseKey )
+{
+    std::default_random_engine RandomEngine( 11 );
+    std::uniform_int_distribution<int> RandomValue( 0, 10000 );
+
+    Array<int> values;
+    for ( int i = 0; i < 200; i++ )
+        values.insert( RandomValue( RandomEngine ) );
+    Heap<int> H( values.begin(), values.end() );
+    std::vector<int> reference( values.begin(), values.end() );
+
+    std::vector<Heap<int>::Handle> handles;
+    for ( int i = 0; i < 300; i++ )
+    {
+        int value = RandomValue( RandomEngine );
+        handles.push_back( H.push( value ) );
+        reference.push_back( value );
+    }
+    for ( int i = 0; i < 100; i++ )
+    {
+        Heap<int>::Handle handle = handles[i * 3];
+        int value = H.get( handle );
+        *std::find( reference.begin(), reference.end(), value ) = value - 500;
+        H.decrease_key( handle, value - 500 );
+        EXPECT_EQ( H.get( handle ), value - 500 );
+    }
+    Heap<int>::Handle handle = handles[1];
+    *std::find( reference.begin(), reference.end(), H.get( handle ) ) = 20000;
+    H.update( handle, 20000 );
+
+    std::sort( reference.begin(), reference.end() );
+    ASSERT_EQ( H.length(), reference.size() );
+    for ( std::size_t i = 0; i < reference.size(); i++ )
+    {
+        EXPECT_EQ( H.top(), reference[i] );
+        EXPECT_EQ( H.pop(), reference[i] );
+    }
+    EXPECT_FALSE( H.contains( handle ) );
+    EXPECT_THROW( H.pop(), std::out_of_range );
+
+    Heap<std::string, 2, std::greater<std::string>> M;
+    M.push( "b" );
+    M.push( "c" );
+    M.push( "a" );
+    EXPECT_EQ( M.pop(), "c" );
+    EXPECT_EQ( M.pop(), "b" );
+}
+
+
+TEST( ArrayTest, Views )
+{
+    Array<int> A;
+    for ( int i = 0; i < 20; i++ )
+        A.insert( i );
+
+    Slice<int> middle = slice( A, 5, 15 );
+    EXPECT_EQ( middle.length(), 10u );
+    std::reverse( middle.begin(), middle.end() );
+    EXPECT_EQ( A[5], 14 );
+    EXPECT_EQ( A[14], 5 );
+
+    StridedView<int> even = strided( A, 0, 20, 2 );
+    StridedView<int> odd = strided( A, 1, 20, 2 );
+    EXPECT_EQ( even.length(), 10u );
+    EXPECT_EQ( strided( A, 1, 20, 3 ).length(), 7u );
+    EXPECT_THROW( strided( A, 0, 20, 0 ), std::invalid_argument );
+    std::sort( even.begin(), even.end(), std::greater<int>() );
+    EXPECT_EQ( A[0], 18 );
+    EXPECT_EQ( A[18], 0 );
+    EXPECT_EQ( odd[0], 1 );
+    EXPECT_EQ( odd[2], 14 );
+    EXPECT_EQ( odd[9], 19 );
+
+    StridedView<int> back = reversed( A );
+    EXPECT_EQ( back[0], A[19] );
+    EXPECT_EQ( back.end() - back.begin(), 20 );
+    std::sort( back.begin(), back.end() );
+    EXPECT_TRUE( std::is_sorted( A.rbegin(), A.rend() ) );
+
+    const Array<int>& C = A;
+    Slice<const int> all = slice( C, 0, C.length() );
+    EXPECT_EQ( std::accumulate( all.begin(), all.end(), 0 ), 190 );
+    Array<int> empty;
+    EXPECT_EQ( reversed( empty ).begin(), reversed( empty ).end() );
+}
+
+TEST( GapArrayTest, RandomEdits )
+{
+    std::default_random_engine RandomEngine( 42 );
+    GapArray<std::string> A( 1 );
+    std::vector<std::string> V;
+    for ( int i = 0; i < 2000; i++ )
+    {
+        int index = std::uniform_int_distribution<int>( 0, (int) V.size() )( RandomEngine );
+        if ( i % 3 == 2 && !V.empty() )
+        {
+            index = index % V.size();
+            A.remove( index );
+            V.erase( V.begin() + index );
+        }
+        else
+        {
+            EXPECT_EQ( A.insert( index, std::to_string( i ) ), (std::size_t) index );
+            V.insert( V.begin() + index, std::to_string( i ) );
+        }
+    }
+    EXPECT_EQ( A.length(), V.size() );
+    for ( std::size_t i = 0; i < A.length(); i++ )
+        EXPECT_EQ( A[i], V[i] );
+
+    A.insert( 0, A[5] );
+    V.insert( V.begin(), V[5] );
+    EXPECT_EQ( A[0], V[0] );
+    std::size_t middle = V.size() / 2;
+    A.insert( middle, A[0] );
+    V.insert( V.begin() + middle, V[0] );
+    EXPECT_EQ( A[middle], V[0] );
+
+    GapArray<std::string> B( A );
+    GapArray<std::string> C;
+    C = std::move( A );
+    std::size_t i = 0;
+    for ( auto it = B.iterator(); it.hasCurrent(); it.next() )
+    {
+        EXPECT_EQ( it.get(), C[i] );
+        i++;
+    }
+    EXPECT_EQ( i, V.size() );
+
+    i = V.size();
+    for ( auto it = C.reverseIterator(); it.hasCurrent(); it.next() )
+    {
+        i--;
+        EXPECT_EQ( it.get(), V[i] );
+    }
+    EXPECT_EQ( i, 0u );
+
+    GapArray<int> D;
+    EXPECT_FALSE( D.reverseIterator().hasCurrent() );
+}
+
+
+TEST( TieredArrayTest, RandomEdits )
+{
+    std::default_random_engine RandomEngine( 42 );
+    TieredArray<std::string> A;
+    std::vector<std::string> V;
+    for ( int i = 0; i < 3000; i++ )
+    {
+        int index = std::uniform_int_distribution<int>( 0, (int) V.size() )( RandomEngine );
+        if ( i % 3 == 2 && !V.empty() )
+        {
+            index = index % V.size();
+            A.remove( index );
+            V.erase( V.begin() + index );
+        }
+        else
+        {
+            EXPECT_EQ( A.insert( index, std::to_string( i ) ), (std::size_t) index );
+            V.insert( V.begin() + index, std::to_string( i ) );
+        }
+    }
+    EXPECT_EQ( A.length(), V.size() );
+    for ( std::size_t i = 0; i < A.length(); i++ )
+        EXPECT_EQ( A[i], V[i] );
+
+    TieredArray<std::string> B( A );
+    TieredArray<std::string> C;
+    C = std::move( A );
+    std::size_t i = 0;
+    for ( auto it = B.iterator(); it.hasCurrent(); it.next() )
+    {
+        EXPECT_EQ( it.get(), C[i] );
+        i++;
+    }
+    EXPECT_EQ( i, V.size() );
+
+    i = V.size();
+    for ( auto it = C.reverseIterator(); it.hasCurrent(); it.next() )
+    {
+        i--;
+        EXPECT_EQ( it.get(), V[i] );
+    }
+    EXPECT_EQ( i, 0u );
+
+    TieredArray<int> D;
+    EXPECT_FALSE( D.reverseIterator().hasCurrent() );
+}
+
+
+TEST( TieredArrayTest, GrowAndShrink )
+{
+    // enough elements to enlarge the blocks twice and shrink them back
+    std::default_random_engine RandomEngine( 7 );
+    TieredArray<int> A;
+    std::vector<int> V;
+    for ( int i = 0; i < 100000; i++ )
+    {
+        int index = std::uniform_int_distribution<int>( 0, (int) V.size() )( RandomEngine );
+        A.insert( index, i );
+        V.insert( V.begin() + index, i );
+    }
+    ASSERT_EQ( A.length(), V.size() );
+    for ( std::size_t i = 0; i < A.length(); i++ )
+        ASSERT_EQ( A[i], V[i] );
+
+    while ( V.size() > 10 )
+    {
+        int index = std::uniform_int_distribution<int>( 0, (int) V.size() - 1 )( RandomEngine );
+        A.remove( index );
+        V.erase( V.begin() + index );
+    }
+    ASSERT_EQ( A.length(), V.size() );
+    for ( std::size_t i = 0; i < A.length(); i++ )
+        EXPECT_EQ( A[i], V[i] );
+
+    A.insert( 0, A[5] );
+    EXPECT_EQ( A[0], V[5] );
+}
+
+
+TEST( SegmentedArrayTest, StableReferences )
+{
+    SegmentedArray<int, 16> A;
+    A.insert( 0 );
+    int* first = &A[0];
+    for ( int i = 1; i < 1000; i++ )
+        A.insert( i );
+    EXPECT_EQ( first, &A[0] );
+    EXPECT_EQ( A.length(), 1000 );
+    EXPECT_EQ( A[999], 999 );
+
+    A.insert( 10, -1 );
+    EXPECT_EQ( A[10], -1 );
+    EXPECT_EQ( A[11], 10 );
+    EXPECT_EQ( A[1000], 999 );
+    for ( int i = 0; i < 900; i++ )
+        A.remove( A.length() - 1 );
+    A.remove( 10 );
+    EXPECT_EQ( A.length(), 100 );
+    for ( std::size_t i = 0; i < A.length(); i++ )
+        EXPECT_EQ( A[i], i );
+
+    SegmentedArray<std::string, 4> B;
+    for ( int i = 0; i < 50; i++ )
+        B.insert( 0, std::to_string( i ) );
+    B.insert( 0, B[5] );
+    EXPECT_EQ( B[0], "44" );
+    B.remove( 0 );
+    SegmentedArray<std::string, 4> C( B );
+    SegmentedArray<std::string, 4> D;
+    D = std::move( B );
+    EXPECT_EQ( B.length(), 0 );
+    B.insert( "reused" );
+    EXPECT_EQ( B[0], "reused" );
+    int i = 50;
+    for ( auto it = C.iterator(); it.hasCurrent(); it.next() )
+    {
+        i--;
+        EXPECT_EQ( it.get(), std::to_string( i ) );
+    }
+    for ( auto it = D.reverseIterator(); it.hasCurrent(); it.next() )
+    {
+        EXPECT_EQ( it.get(), std::to_string( i ) );
+        i++;
+    }
+}
+
+
+TEST( ConcurrentArrayTest, ParallelInsert )
+{
+    constexpr int THREADS = 4;
+    constexpr int PER_THREAD = 20000;
+    ConcurrentArray<std::pair<int, int>> A;
+
+    std::vector<std::thread> writers;
+    for ( int t = 0; t < THREADS; t++ )
+        writers.emplace_back( [&A, t]()
+        {
+            for ( int i = 0; i < PER_THREAD; i++ )
+                A.emplace_back( t, i );
+        } );
+
+    std::size_t seen = 0;
+    while ( seen < THREADS * PER_THREAD )
+    {
+        for ( auto it = A.iterator(); it.hasCurrent(); it.next() )
+            EXPECT_LT( it.get().second, PER_THREAD );
+        seen = A.length();
+    }
+    for ( auto& writer : writers )
+        writer.join();
+
+    EXPECT_EQ( A.length(), THREADS * PER_THREAD );
+    std::vector<int> last( THREADS, -1 );
+    for ( std::size_t i = 0; i < A.length(); i++ )
+    {
+        EXPECT_EQ( A[i].second, last[A[i].first] + 1 );
+        last[A[i].first] = A[i].second;
+    }
+}
+
+
+TEST( ConcurrentArrayTest, ThrowingConstructor )
+{
+    struct Checked
+    {
+        int value;
+        Checked( int value ): value( value )
+        {
+            if ( value < 0 )
+                throw std::invalid_argument( "negative" );
+        }
+    };
+
+    ConcurrentArray<Checked> A;
+    for ( int i = 0; i < 100; i++ )
+    {
+        if ( i % 10 == 3 )
+            EXPECT_THROW( A.emplace_back( -i ), std::invalid_argument );
+        else
+            A.emplace_back( i );
+    }
+    // the holes are published, so the inserts after them are visible
+    EXPECT_EQ( A.length(), 100u );
+    EXPECT_FALSE( A.has( 3 ) );
+    EXPECT_TRUE( A.has( 4 ) );
+    EXPECT_EQ( A[99].value, 99 );
+
+    int count = 0;
+    for ( auto it = A.iterator(); it.hasCurrent(); it.next() )
+    {
+        EXPECT_NE( it.get().value % 10, 3 );
+        count++;
+    }
+    EXPECT_EQ( count, 90 );
+    count = 0;
+    for ( auto it = A.reverseIterator(); it.hasCurrent(); it.next() )
+        count++;
+    EXPECT_EQ( count, 90 );
+}
+
+
+TEST( SoaArrayTest, Columns )
+{
+    SoaArray<int, double, std::string> A( 4 );
+    for ( int i = 0; i < 100; i++ )
+        EXPECT_EQ( A.insert( i, i * 0.5, std::to_string( i ) ), i );
+    EXPECT_EQ( A.insert( 0, -1, -0.5, "first" ), 0 );
+    A.remove( 50 );
+    EXPECT_EQ( A.length(), 100 );
+
+    EXPECT_EQ( std::get<0>( A[0] ), -1 );
+    EXPECT_EQ( std::get<2>( A[0] ), "first" );
+    EXPECT_EQ( std::get<0>( A[50] ), 50 );
+    EXPECT_EQ( std::get<1>( A[50] ), 25.0 );
+
+    std::get<1>( A[1] ) = 100.0;
+    auto ids = A.column<0>();
+    EXPECT_EQ( ids.length(), 100 );
+    EXPECT_EQ( std::accumulate( ids.begin(), ids.end(), 0 ), 4950 - 49 - 1 );
+    for ( double& x : A.column<1>() )
+        x *= 2;
+
+    const SoaArray<int, double, std::string>& C = A;
+    EXPECT_EQ( C.column<1>()[1], 200.0 );
+    EXPECT_EQ( std::get<1>( C[2] ), 1.0 );
+    EXPECT_EQ( C.column<2>()[99], "99" );
+}
+
+
+TEST( SoaArrayTest, ThrowingInsert )
+{
+    struct Fragile
+    {
+        bool fail;
+        Fragile( bool fail ): fail( fail ) {}
+        Fragile( const Fragile& other ): fail( other.fail )
+        {
+            if ( fail )
+                throw std::runtime_error( "copy failed" );
+        }
+        Fragile( Fragile&& other ) noexcept: fail( other.fail ) {}
+        Fragile& operator = ( Fragile&& other ) noexcept { fail = other.fail; return *this; }
+    };
+
+    SoaArray<int, std::string, Fragile> A;
+    for ( int i = 0; i < 10; i++ )
+        A.insert( i, std::to_string( i ), Fragile( false ) );
+    EXPECT_THROW( A.insert( 5, -1, "bad", Fragile( true ) ), std::runtime_error );
+
+    // the first two columns got the record back out
+    EXPECT_EQ( A.length(), 10u );
+    EXPECT_EQ( A.column<0>().length(), 10u );
+    EXPECT_EQ( A.column<1>().length(), 10u );
+    EXPECT_EQ( A.column<2>().length(), 10u );
+    for ( int i = 0; i < 10; i++ )
+    {
+        EXPECT_EQ( std::get<0>( A[i] ), i );
+        EXPECT_EQ( std::get<1>( A[i] ), std::to_string( i ) );
+    }
+}
+
+
+TEST( MappedArrayTest, Reopen )
+{
+    std::string path = ::testing::TempDir() + "mapped_array_test.bin";
+    std::remove( path.c_str() );
+    {
+        MappedArray<Point> A( path, 2 );
+        for ( int i = 0; i < 1000; i++ )
+            A.insert( Point{ i, i * 0.5 } );
+        A.insert( 0, Point{ -1, -0.5 } );
+        A.remove( 500 );
+        EXPECT_EQ( A.length(), 1000 );
+        A.flush();
+    }
+    {
+        MappedArray<Point> B( path );
+        EXPECT_EQ( B.length(), 1000 );
+        EXPECT_EQ( B[0].x, -1 );
+        EXPECT_EQ( B[499].x, 498 );
+        EXPECT_EQ( B[500].x, 500 );
+        EXPECT_EQ( B[999].y, 499.5 );
+        B.insert( Point{ 1000, 500.0 } );
+        int sum = 0;
+        for ( const Point& p : B )
+            sum += p.x;
+        EXPECT_EQ( sum, 499500 - 1 - 499 + 1000 );
+
+        Slice<Point> head = slice( B, 0, 10 );
+        std::reverse( head.begin(), head.end() );
+        EXPECT_EQ( B[0].x, 8 );
+        EXPECT_EQ( B[9].x, -1 );
+        EXPECT_EQ( strided( B, 0, 1001, 100 )[10].x, 1000 );
+    }
+    EXPECT_THROW( MappedArray<int> C( path ), std::runtime_error );
+
+    // a length beyond the file size
+    {
+        std::FILE* file = std::fopen( path.c_str(), "r+b" );
+        std::uint64_t size = 1000000;
+        std::fseek( file, 16, SEEK_SET );
+        std::fwrite( &size, sizeof( size ), 1, file );
+        std::fseek( file, 24, SEEK_SET );
+        std::fwrite( &size, sizeof( size ), 1, file );
+        std::fclose( file );
+    }
+    EXPECT_THROW( MappedArray<Point> D( path ), std::runtime_error );
+
+    // a short foreign file is kept as it is
+    {
+        std::FILE* file = std::fopen( path.c_str(), "wb" );
+        std::fputs( "not an array", file );
+        std::fclose( file );
+    }
+    EXPECT_THROW( MappedArray<Point> E( path ), std::runtime_error );
+    {
+        std::FILE* file = std::fopen( path.c_str(), "rb" );
+        char text[32] = {};
+        EXPECT_EQ( std::fread( text, 1, sizeof( text ), file ), 12 );
+        EXPECT_STREQ( text, "not an array" );
+        std::fclose( file );
+    }
+    std::remove( path.c_str() );
 }
\ No newline at end of file
@@ -0,0 +1,519 @@
+#pragma once
+
+#include <limits>
+#include <new>
+#include <stdexcept>
+
+#include "Array.h"
+
+/* tiered vector: the elements lie in blocks of block_size() slots, each block
+   is a ring buffer and all blocks but the last one are full. An edit shifts
+   elements inside one block and passes one element across each following
+   block boundary, so it costs O(block_size() + length() / block_size()).
+   block_size() follows sqrt( length() ), which makes an edit at any position
+   O(sqrt( n )) while operator [] stays O(1) */
+
+constexpr std::size_t TIERED_ARRAY_MIN_SHIFT = 6;
+
+template<typename T>
+class TieredArray final
+{
+	public:
+		TieredArray();
+		TieredArray( std::size_t capacity );
+		TieredArray( const TieredArray& other );
+		TieredArray( TieredArray&& other );
+		~TieredArray();
+
+		TieredArray& operator = ( const TieredArray& other );
+		TieredArray& operator = ( TieredArray&& other );
+
+		std::size_t insert( const T& value );
+		std::size_t insert( std::size_t index, const T& value );
+		void remove( std::size_t index );
+
+		const T& operator [] ( std::size_t index ) const;
+		T& operator [] ( std::size_t index );
+		std::size_t length() const;
+
+
+		class Iterator
+		{
+			public:
+				Iterator( TieredArray* array, int step );
+				T& get() const;
+				void set( const T& value );
+				void next();
+				bool hasCurrent() const;
+			private:
+				TieredArray* array;
+				std::size_t index;
+				int step;
+		};
+
+		Iterator iterator();
+		Iterator reverseIterator();
+
+		class ConstIterator
+		{
+			public:
+				ConstIterator( const TieredArray* array, int step );
+				const T& get() const;
+				void next();
+				bool hasCurrent() const;
+			private:
+				const TieredArray* array;
+				std::size_t index;
+				int step;
+		};
+
+		ConstIterator iterator() const;
+		ConstIterator reverseIterator() const;
+
+	private:
+		/* ring buffer, its first element is at a[head] */
+		struct Block
+		{
+			T* a;
+			std::size_t head;
+		};
+
+		Array<Block> blocks;
+		std::size_t size;
+		/* block_size() == 2^shift */
+		std::size_t shift;
+		/* memory of the last freed block, kept so that edits around
+		   a block boundary do not allocate and free it every time */
+		T* spare;
+
+		std::size_t block_size() const;
+		T& slot( const Block& block, std::size_t position ) const;
+		void clear();
+		void add_block();
+		void remove_block();
+		void rebuild( std::size_t new_shift );
+
+		static std::size_t shift_for( std::size_t length );
+		static T* allocate( std::size_t capacity );
+};
+
+
+/* default costructor */
+template<typename T>
+TieredArray<T>::TieredArray():
+	TieredArray( 0 )
+{}
+
+
+/* with parameter: only the block size is chosen for capacity elements,
+   blocks are allocated as the array grows */
+template<typename T>
+TieredArray<T>::TieredArray( std::size_t capacity ):
+	blocks(),
+	size( 0 ),
+	shift( shift_for( capacity ) ),
+	spare( nullptr )
+{}
+
+
+/* the smallest block size with length <= 4 * block_size^2 */
+template<typename T>
+std::size_t TieredArray<T>::shift_for( std::size_t length )
+{
+	std::size_t shift = TIERED_ARRAY_MIN_SHIFT;
+	while ( ( length >> 2 ) >> shift > ( (std::size_t) 1 << shift ) )
+	{
+		shift++;
+	}
+	return shift;
+}
+
+
+template<typename T>
+T* TieredArray<T>::allocate( std::size_t capacity )
+{
+	if ( capacity > std::numeric_limits<std::size_t>::max() / sizeof( T ) )
+	{
+		throw std::length_error( "TieredArray block is too big" );
+	}
+	T* memory = (T*) std::malloc( capacity * sizeof( T ) );
+	if ( memory == nullptr )
+	{
+		throw std::bad_alloc();
+	}
+	return memory;
+}
+
+
+/* copy constructor */
+template<typename T>
+TieredArray<T>::TieredArray( const TieredArray<T>& other ):
+	TieredArray()
+{
+	shift = other.shift;
+	/* size counts only constructed elements: if a copy throws,
+	   the destructor destroys just those */
+	for ( std::size_t i = 0; i < other.size; i++ )
+	{
+		if ( size == blocks.length() << shift )
+		{
+			add_block();
+		}
+		new( &slot( blocks[blocks.length() - 1], size & ( block_size() - 1 ) ) ) T( other[i] );
+		size++;
+	}
+}
+
+
+/* move constructor */
+template<typename T>
+TieredArray<T>::TieredArray( TieredArray<T>&& other ):
+	blocks( std::move( other.blocks ) ),
+	size( other.size ),
+	shift( other.shift ),
+	spare( other.spare )
+{
+	other.size = 0;
+	other.spare = nullptr;
+}
+
+
+/* destructor */
+template<typename T>
+TieredArray<T>::~TieredArray()
+{
+	clear();
+}
+
+
+/* copy assignment */
+template<typename T>
+TieredArray<T>& TieredArray<T>::operator = ( const TieredArray<T>& other )
+{
+	TieredArray<T> copy( other );
+	std::swap( blocks, copy.blocks );
+	std::swap( size, copy.size );
+	std::swap( shift, copy.shift );
+	std::swap( spare, copy.spare );
+	return *this;
+}
+
+
+/* move assignment */
+template<typename T>
+TieredArray<T>& TieredArray<T>::operator = ( TieredArray<T>&& other )
+{
+	if ( this != &other )
+	{
+		clear();
+		blocks = std::move( other.blocks );
+		size = other.size;
+		shift = other.shift;
+		spare = other.spare;
+		other.size = 0;
+		other.spare = nullptr;
+	}
+	return *this;
+}
+
+
+/* memory freeing */
+template<typename T>
+void TieredArray<T>::clear()
+{
+	if constexpr ( !std::is_trivially_destructible<T>::value )
+	{
+		for ( std::size_t i = 0; i < size; i++ )
+		{
+			( *this )[i].~T();
+		}
+	}
+	for ( std::size_t i = 0; i < blocks.length(); i++ )
+	{
+		std::free( blocks[i].a );
+	}
+	std::free( spare );
+	spare = nullptr;
+}
+
+
+template<typename T>
+std::size_t TieredArray<T>::block_size() const
+{
+	return (std::size_t) 1 << shift;
+}
+
+
+/* slot of the element at position in the block */
+template<typename T>
+T& TieredArray<T>::slot( const Block& block, std::size_t position ) const
+{
+	return block.a[( block.head + position ) & ( block_size() - 1 )];
+}
+
+
+/* appending an empty block */
+template<typename T>
+void TieredArray<T>::add_block()
+{
+	Block block{ spare != nullptr ? spare : allocate( block_size() ), 0 };
+	spare = nullptr;
+	try
+	{
+		blocks.insert( block );
+	}
+	catch ( ... )
+	{
+		spare = block.a;
+		throw;
+	}
+}
+
+
+/* dropping the last block, which is empty */
+template<typename T>
+void TieredArray<T>::remove_block()
+{
+	T* a = blocks[blocks.length() - 1].a;
+	blocks.remove( blocks.length() - 1 );
+	if ( spare == nullptr )
+	{
+		spare = a;
+	}
+	else
+	{
+		std::free( a );
+	}
+}
+
+
+/* moving all elements to blocks of 2^new_shift slots; the new blocks are
+   allocated first, so if that throws the array stays as it was */
+template<typename T>
+void TieredArray<T>::rebuild( std::size_t new_shift )
+{
+	const std::size_t new_block_size = (std::size_t) 1 << new_shift;
+	const std::size_t count = ( size + new_block_size - 1 ) >> new_shift;
+	Array<Block> rebuilt( count );
+	try
+	{
+		for ( std::size_t i = 0; i < count; i++ )
+		{
+			rebuilt.insert( Block{ allocate( new_block_size ), 0 } );
+		}
+	}
+	catch ( ... )
+	{
+		for ( std::size_t i = 0; i < rebuilt.length(); i++ )
+		{
+			std::free( rebuilt[i].a );
+		}
+		throw;
+	}
+	for ( std::size_t i = 0; i < size; i++ )
+	{
+		relocate( &( *this )[i], rebuilt[i >> new_shift].a + ( i & ( new_block_size - 1 ) ), 1 );
+	}
+	for ( std::size_t i = 0; i < blocks.length(); i++ )
+	{
+		std::free( blocks[i].a );
+	}
+	std::free( spare );
+	spare = nullptr;
+	blocks = std::move( rebuilt );
+	shift = new_shift;
+}
+
+
+template<typename T>
+std::size_t TieredArray<T>::insert( const T& value )
+{
+	return insert( size, value );
+}
+
+
+template<typename T>
+std::size_t TieredArray<T>::insert( std::size_t index, const T& value )
+{
+	/* value may be an element of the array itself */
+	T copy( value );
+	if ( ( ( size + 1 ) >> 2 ) >> shift > block_size() )
+	{
+		rebuild( shift + 1 );
+	}
+	if ( size == blocks.length() << shift )
+	{
+		add_block();
+	}
+	const std::size_t mask = block_size() - 1;
+	const std::size_t k = index >> shift;
+	const std::size_t last = blocks.length() - 1;
+	/* the last element of every full block from k on
+	   becomes the first element of the next block */
+	for ( std::size_t j = last; j > k; j-- )
+	{
+		Block& to = blocks[j];
+		to.head = ( to.head - 1 ) & mask;
+		relocate( &slot( blocks[j - 1], mask ), to.a + to.head, 1 );
+	}
+	/* shifting the rest of block k by one slot */
+	Block& block = blocks[k];
+	const std::size_t count = k == last ? size - ( last << shift ) : mask;
+	const std::size_t position = index & mask;
+	for ( std::size_t p = count; p > position; p-- )
+	{
+		relocate( &slot( block, p - 1 ), &slot( block, p ), 1 );
+	}
+	new( &slot( block, position ) ) T( std::move( copy ) );
+	size++;
+	return index;
+}
+
+
+template<typename T>
+void TieredArray<T>::remove( std::size_t index )
+{
+	if ( shift > TIERED_ARRAY_MIN_SHIFT && ( size - 1 ) >> shift < block_size() >> 2 )
+	{
+		rebuild( shift - 1 );
+	}
+	const std::size_t mask = block_size() - 1;
+	const std::size_t k = index >> shift;
+	const std::size_t last = blocks.length() - 1;
+	Block& block = blocks[k];
+	const std::size_t count = k == last ? size - ( last << shift ) : block_size();
+	const std::size_t position = index & mask;
+	slot( block, position ).~T();
+	for ( std::size_t p = position + 1; p < count; p++ )
+	{
+		relocate( &slot( block, p ), &slot( block, p - 1 ), 1 );
+	}
+	/* the first element of every following block
+	   becomes the last element of the previous block */
+	for ( std::size_t j = k + 1; j <= last; j++ )
+	{
+		Block& from = blocks[j];
+		relocate( from.a + from.head, &slot( blocks[j - 1], mask ), 1 );
+		from.head = ( from.head + 1 ) & mask;
+	}
+	size--;
+	if ( size == last << shift )
+	{
+		remove_block();
+	}
+}
+
+
+template<typename T>
+const T& TieredArray<T>::operator [] ( std::size_t index ) const
+{
+	return slot( blocks[index >> shift], index );
+}
+
+
+template<typename T>
+T& TieredArray<T>::operator [] ( std::size_t index )
+{
+	return slot( blocks[index >> shift], index );
+}
+
+
+template<typename T>
+std::size_t TieredArray<T>::length() const
+{
+	return size;
+}
+
+
+
+/* iterators */
+
+
+template<typename T>
+TieredArray<T>::Iterator::Iterator( TieredArray<T>* array, int step ):
+	array( array ),
+	index( step > 0 ? 0 : ( array->length() - 1 ) ),
+	step( step )
+{}
+
+template<typename T>
+void TieredArray<T>::Iterator::next()
+{
+	index += step;
+}
+
+template<typename T>
+bool TieredArray<T>::Iterator::hasCurrent() const
+{
+	/* stepping below 0 wraps around to a huge index */
+	return index < array->length();
+}
+
+template<typename T>
+T& TieredArray<T>::Iterator::get() const
+{
+	return ( *array )[index];
+}
+
+template<typename T>
+void TieredArray<T>::Iterator::set( const T& value )
+{
+	( *array )[index] = value;
+}
+
+
+template<typename T>
+TieredArray<T>::ConstIterator::ConstIterator( const TieredArray<T>* array, int step ):
+	array( array ),
+	index( step > 0 ? 0 : ( array->length() - 1 ) ),
+	step( step )
+{}
+
+template<typename T>
+void TieredArray<T>::ConstIterator::next()
+{
+	index += step;
+}
+
+template<typename T>
+bool TieredArray<T>::ConstIterator::hasCurrent() const
+{
+	/* stepping below 0 wraps around to a huge index */
+	return index < array->length();
+}
+
+template<typename T>
+const T& TieredArray<T>::ConstIterator::get() const
+{
+	return ( *array )[index];
+}
+
+
+
+template<typename T>
+typename TieredArray<T>::Iterator TieredArray<T>::iterator()
+{
+	TieredArray<T>::Iterator iterator( this, 1 );
+	return iterator;
+}
+
+template<typename T>
+typename TieredArray<T>::ConstIterator TieredArray<T>::iterator() const
+{
+	TieredArray<T>::ConstIterator iterator( this, 1 );
+	return iterator;
+}
+
+template<typename T>
+typename TieredArray<T>::Iterator TieredArray<T>::reverseIterator()
+{
+	TieredArray<T>::Iterator iterator( this, -1 );
+	return iterator;
+}
+
+template<typename T>
+typename TieredArray<T>::ConstIterator TieredArray<T>::reverseIterator() const
+{
+	TieredArray<T>::ConstIterator iterator( this, -1 );
+	return iterator;
+}
@@ -0,0 +1,127 @@
+#pragma once
+
+#include <cstddef>
+#include <iterator>
+#include <stdexcept>
+#include <type_traits>
+
+/* non-owning views of contiguous elements (Array, MappedArray, views
+   themselves); valid until the viewed array reallocates or shrinks.
+   Their iterators are random access, so the views can be given to
+   hybrid_sort or <algorithm> and change the array in place */
+
+
+/* contiguous elements [first, first + length), iterators are plain pointers */
+template<typename T>
+class Slice
+{
+	public:
+		Slice( T* data, std::size_t size ): a( data ), size( size ) {}
+
+		T& operator [] ( std::size_t index ) const { return a[index]; }
+		std::size_t length() const { return size; }
+		T* data() const { return a; }
+		T* begin() const { return a; }
+		T* end() const { return a + size; }
+
+	private:
+		T* a;
+		std::size_t size;
+};
+
+
+/* iterator over every step-th element, step may be negative; keeps the
+   index instead of a pointer so that the past-the-end position never
+   points outside the array */
+template<typename T>
+class StridedIterator
+{
+	public:
+		using iterator_category = std::random_access_iterator_tag;
+		using value_type = std::remove_cv_t<T>;
+		using difference_type = std::ptrdiff_t;
+		using pointer = T*;
+		using reference = T&;
+
+		StridedIterator(): base( nullptr ), index( 0 ), step( 1 ) {}
+		StridedIterator( T* base, std::ptrdiff_t index, std::ptrdiff_t step ): base( base ), index( index ), step( step ) {}
+
+		T& operator * () const { return base[index * step]; }
+		T* operator -> () const { return base + index * step; }
+		T& operator [] ( std::ptrdiff_t n ) const { return base[( index + n ) * step]; }
+
+		StridedIterator& operator ++ () { index++; return *this; }
+		StridedIterator& operator -- () { index--; return *this; }
+		StridedIterator operator ++ ( int ) { StridedIterator old = *this; index++; return old; }
+		StridedIterator operator -- ( int ) { StridedIterator old = *this; index--; return old; }
+		StridedIterator& operator += ( std::ptrdiff_t n ) { index += n; return *this; }
+		StridedIterator& operator -= ( std::ptrdiff_t n ) { index -= n; return *this; }
+		StridedIterator operator + ( std::ptrdiff_t n ) const { return StridedIterator( base, index + n, step ); }
+		StridedIterator operator - ( std::ptrdiff_t n ) const { return StridedIterator( base, index - n, step ); }
+		friend StridedIterator operator + ( std::ptrdiff_t n, const StridedIterator& it ) { return it + n; }
+		std::ptrdiff_t operator - ( const StridedIterator& other ) const { return index - other.index; }
+
+		bool operator == ( const StridedIterator& other ) const { return index == other.index; }
+		bool operator != ( const StridedIterator& other ) const { return index != other.index; }
+		bool operator < ( const StridedIterator& other ) const { return index < other.index; }
+		bool operator > ( const StridedIterator& other ) const { return index > other.index; }
+		bool operator <= ( const StridedIterator& other ) const { return index <= other.index; }
+		bool operator >= ( const StridedIterator& other ) const { return index >= other.index; }
+
+	private:
+		T* base;
+		std::ptrdiff_t index;
+		std::ptrdiff_t step;
+};
+
+
+/* length elements first[0], first[step], first[2 * step], ... */
+template<typename T>
+class StridedView
+{
+	public:
+		StridedView( T* first, std::size_t size, std::ptrdiff_t step ): first( first ), size( size ), step( step ) {}
+
+		T& operator [] ( std::size_t index ) const { return first[(std::ptrdiff_t) index * step]; }
+		std::size_t length() const { return size; }
+		StridedIterator<T> begin() const { return StridedIterator<T>( first, 0, step ); }
+		StridedIterator<T> end() const { return StridedIterator<T>( first, (std::ptrdiff_t) size, step ); }
+
+	private:
+		T* first;
+		std::size_t size;
+		std::ptrdiff_t step;
+};
+
+
+/* elements [first, last) of a contiguous container */
+template<typename Container>
+auto slice( Container& container, std::size_t first, std::size_t last )
+{
+	using T = std::remove_pointer_t<decltype( container.data() )>;
+	return Slice<T>( container.data() + first, last - first );
+}
+
+
+/* elements first, first + step, ... below last; step must be positive */
+template<typename Container>
+auto strided( Container& container, std::size_t first, std::size_t last, std::size_t step )
+{
+	using T = std::remove_pointer_t<decltype( container.data() )>;
+	if ( step == 0 )
+	{
+		throw std::invalid_argument( "strided view step is 0" );
+	}
+	std::size_t size = last > first ? ( last - first + step - 1 ) / step : 0;
+	return StridedView<T>( container.data() + first, size, (std::ptrdiff_t) step );
+}
+
+
+/* all elements from the last one to the first one */
+template<typename Container>
+auto reversed( Container& container )
+{
+	using T = std::remove_pointer_t<decltype( container.data() )>;
+	std::size_t size = container.length();
+	return StridedView<T>( container.data() + ( size > 0 ? size - 1 : 0 ), size, -1 );
+}
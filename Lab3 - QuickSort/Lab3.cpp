@@ -1,14 +1,19 @@
+#include <algorithm>
 #include <iostream>
 #include <fstream>
 #include <ctime>
 #include <ratio>
 #include <chrono>
+#include <random>
+#include <string>
+#include <vector>
 
 #include "Sort.h"
 
 
 constexpr int REPETITION_COUNT = 50000;
 constexpr int MAX_LENGTH = 32;
+constexpr int PATTERN_LENGTH = 1000000;
 
 bool comp( int a, int b ) { return a < b; }
 
@@ -20,13 +25,14 @@ void benchmark()
 
     std::ofstream file;
     file.open( "benchmark.csv", std::ofstream::out | std::ofstream::trunc );
-    file << "count;insertion;quick;";
+    file << "count;insertion;quick;network;";
     file << '\n';
 
     for ( int last_index = 0; last_index < MAX_LENGTH; last_index++ )
     {
         double insertion_time = 0.0;
         double quick_time = 0.0;
+        double network_time = 0.0;
 
         for ( int j = 0; j < REPETITION_COUNT; j++ )
         {
@@ -45,9 +51,71 @@ void benchmark()
             steady_clock::time_point t4 = steady_clock::now();
             duration<double> quick_span = duration_cast<duration<double>>( t4 - t3 );
             quick_time += quick_span.count();
+
+            for ( int i = 0; i <= last_index; i++ )
+                a[i] = last_index - i;
+            steady_clock::time_point t5 = steady_clock::now();
+            network_sort( a, a + last_index, false );
+            steady_clock::time_point t6 = steady_clock::now();
+            duration<double> network_span = duration_cast<duration<double>>( t6 - t5 );
+            network_time += network_span.count();
         }
 
-        file << ( last_index + 1 ) << ';' << insertion_time << ';' << quick_time << ';';
+        file << ( last_index + 1 ) << ';' << insertion_time << ';' << quick_time << ';' << network_time << ';';
+        file << '\n';
+    }
+    file.close();
+}
+
+
+// input of PATTERN_LENGTH elements shaped by pattern
+void fill_pattern( std::vector<int>& a, const char* pattern )
+{
+    std::default_random_engine RandomEngine( 42 );
+    std::uniform_int_distribution<int> RandomIndexGenerator( 0, PATTERN_LENGTH - 1 );
+    std::string name( pattern );
+    for ( int i = 0; i < PATTERN_LENGTH; i++ )
+    {
+        if ( name == "random" )
+            a[i] = RandomIndexGenerator( RandomEngine );
+        else if ( name == "reversed" )
+            a[i] = PATTERN_LENGTH - i;
+        else if ( name == "organ pipe" )
+            a[i] = i < PATTERN_LENGTH / 2 ? i : PATTERN_LENGTH - i;
+        else
+            a[i] = i;
+    }
+    if ( name == "nearly sorted" )
+        for ( int k = 0; k < PATTERN_LENGTH / 1000; k++ )
+            std::swap( a[RandomIndexGenerator( RandomEngine )], a[RandomIndexGenerator( RandomEngine )] );
+}
+
+// hybrid_sort against std::sort on typical input shapes
+void pattern_benchmark()
+{
+    using namespace std::chrono;
+
+    std::vector<int> a( PATTERN_LENGTH );
+
+    std::ofstream file;
+    file.open( "pattern_benchmark.csv", std::ofstream::out | std::ofstream::trunc );
+    file << "pattern;hybrid;std::sort;";
+    file << '\n';
+
+    for ( const char* pattern : { "random", "sorted", "reversed", "nearly sorted", "organ pipe" } )
+    {
+        fill_pattern( a, pattern );
+        steady_clock::time_point t1 = steady_clock::now();
+        hybrid_sort( a.data(), a.data() + PATTERN_LENGTH - 1, comp );
+        steady_clock::time_point t2 = steady_clock::now();
+
+        fill_pattern( a, pattern );
+        steady_clock::time_point t3 = steady_clock::now();
+        std::sort( a.begin(), a.end(), comp );
+        steady_clock::time_point t4 = steady_clock::now();
+
+        file << pattern << ';' << duration_cast<duration<double>>( t2 - t1 ).count() << ';';
+        file << duration_cast<duration<double>>( t4 - t3 ).count() << ';';
         file << '\n';
     }
     file.close();
@@ -57,6 +125,7 @@ void benchmark()
 int main()
 {
     //benchmark(); return 0;
+    //pattern_benchmark(); return 0;
 
     int a[20] = { 7, 20, 19, 5, 14, 3, 18, 6, 2, 11, 17, 10, 9, 15, 4, 13, 8, 16, 12, 1 };
     hybrid_sort( a, a + 19, []( int a, int b ) { return a < b; } );
@@ -0,0 +1,348 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "Sort.h"
+
+/* parallel hybrid_sort: both sides of every partition above
+   PARALLEL_SORT_THRESHOLD elements become tasks of one process-wide
+   work-stealing pool, smaller intervals are sorted sequentially.
+   The pool has hardware_concurrency() - 1 workers and a sorting caller
+   executes tasks itself while it waits, so several threads sorting at
+   once never start more threads than cores. The result does not depend
+   on scheduling: every interval is partitioned the same way as by
+   intro_sort. Numbers compared by std::less go to radix_sort exactly
+   as in hybrid_sort, which is faster than the parallel comparison sort */
+
+constexpr std::ptrdiff_t PARALLEL_SORT_THRESHOLD = 32 * 1024;
+
+
+class SortPool final
+{
+    public:
+        static SortPool& instance();
+
+        SortPool( const SortPool& other ) = delete;
+        ~SortPool();
+
+        SortPool& operator = ( const SortPool& other ) = delete;
+
+        std::size_t worker_count() const;
+        /* to the own queue of a worker thread, otherwise to the shared one */
+        void submit( std::function<void()> task );
+        /* one task from the own queue or stolen from another one,
+           false if all queues are empty */
+        bool run_one();
+        /* blocking until done() holds or there is a task to run;
+           done may only change together with a call of wake_all() */
+        template<typename Predicate>
+        void sleep_until( Predicate done );
+        void wake_all();
+
+    private:
+        struct Queue
+        {
+            std::mutex mutex;
+            std::deque<std::function<void()>> tasks;
+        };
+
+        /* one per worker and the last one for other threads */
+        std::vector<std::unique_ptr<Queue>> queues;
+        std::vector<std::thread> workers;
+        std::atomic<std::ptrdiff_t> pending;
+        bool stopping;
+        std::mutex sleep_mutex;
+        std::condition_variable wake;
+
+        static thread_local std::size_t own_queue;
+
+        SortPool();
+        void work( std::size_t index );
+        bool pop( std::size_t index, bool own, std::function<void()>& task );
+};
+
+
+inline thread_local std::size_t SortPool::own_queue = (std::size_t) -1;
+
+
+inline SortPool& SortPool::instance()
+{
+    static SortPool pool;
+    return pool;
+}
+
+
+inline SortPool::SortPool():
+    pending( 0 ),
+    stopping( false )
+{
+    std::size_t threads = std::thread::hardware_concurrency();
+    std::size_t count = threads > 1 ? threads - 1 : 0;
+    for ( std::size_t i = 0; i <= count; i++ )
+    {
+        queues.emplace_back( new Queue() );
+    }
+    for ( std::size_t i = 0; i < count; i++ )
+    {
+        workers.emplace_back( &SortPool::work, this, i );
+    }
+}
+
+
+inline SortPool::~SortPool()
+{
+    {
+        std::lock_guard<std::mutex> lock( sleep_mutex );
+        stopping = true;
+    }
+    wake.notify_all();
+    for ( auto& worker : workers )
+    {
+        worker.join();
+    }
+}
+
+
+inline std::size_t SortPool::worker_count() const
+{
+    return workers.size();
+}
+
+
+inline void SortPool::submit( std::function<void()> task )
+{
+    std::size_t index = own_queue < workers.size() ? own_queue : workers.size();
+    {
+        std::lock_guard<std::mutex> lock( queues[index]->mutex );
+        queues[index]->tasks.push_back( std::move( task ) );
+    }
+    {
+        std::lock_guard<std::mutex> lock( sleep_mutex );
+        pending++;
+    }
+    wake.notify_one();
+}
+
+
+/* the owner takes the newest task (its data is still in cache),
+   a thief takes the oldest one (the biggest interval) */
+inline bool SortPool::pop( std::size_t index, bool own, std::function<void()>& task )
+{
+    Queue& queue = *queues[index];
+    std::lock_guard<std::mutex> lock( queue.mutex );
+    if ( queue.tasks.empty() )
+    {
+        return false;
+    }
+    if ( own )
+    {
+        task = std::move( queue.tasks.back() );
+        queue.tasks.pop_back();
+    }
+    else
+    {
+        task = std::move( queue.tasks.front() );
+        queue.tasks.pop_front();
+    }
+    pending--;
+    return true;
+}
+
+
+inline bool SortPool::run_one()
+{
+    if ( pending.load() == 0 )
+    {
+        return false;
+    }
+    std::function<void()> task;
+    std::size_t start = own_queue < workers.size() ? own_queue : workers.size();
+    bool found = pop( start, true, task );
+    for ( std::size_t i = 1; !found && i < queues.size(); i++ )
+    {
+        found = pop( ( start + i ) % queues.size(), false, task );
+    }
+    if ( found )
+    {
+        task();
+    }
+    return found;
+}
+
+
+template<typename Predicate>
+void SortPool::sleep_until( Predicate done )
+{
+    std::unique_lock<std::mutex> lock( sleep_mutex );
+    wake.wait( lock, [this, &done]() { return stopping || pending.load() > 0 || done(); } );
+}
+
+
+inline void SortPool::wake_all()
+{
+    {
+        /* a sleeper checks its condition under the mutex, so it either
+           sees the change or is already waiting for this notification */
+        std::lock_guard<std::mutex> lock( sleep_mutex );
+    }
+    wake.notify_all();
+}
+
+
+inline void SortPool::work( std::size_t index )
+{
+    own_queue = index;
+    while ( true )
+    {
+        if ( run_one() )
+        {
+            continue;
+        }
+        std::unique_lock<std::mutex> lock( sleep_mutex );
+        wake.wait( lock, [this]() { return stopping || pending.load() > 0; } );
+        if ( stopping )
+        {
+            return;
+        }
+    }
+}
+
+
+
+/* tasks of one parallel_hybrid_sort call */
+class SortTaskGroup final
+{
+    public:
+        SortTaskGroup(): count( 0 ) {}
+
+        template<typename Function>
+        void run( Function f );
+        /* executing pool tasks until all tasks of the group are done,
+           sleeping while there is nothing to run,
+           then rethrowing the first exception of a task */
+        void wait();
+
+    private:
+        std::atomic<std::ptrdiff_t> count;
+        std::mutex error_mutex;
+        std::exception_ptr error;
+};
+
+
+template<typename Function>
+void SortTaskGroup::run( Function f )
+{
+    count++;
+    SortPool::instance().submit( [this, f]()
+    {
+        try
+        {
+            f();
+        }
+        catch ( ... )
+        {
+            std::lock_guard<std::mutex> lock( error_mutex );
+            error = error ? error : std::current_exception();
+        }
+        if ( --count == 0 )
+        {
+            SortPool::instance().wake_all();
+        }
+    } );
+}
+
+
+inline void SortTaskGroup::wait()
+{
+    SortPool& pool = SortPool::instance();
+    while ( count.load() > 0 )
+    {
+        if ( !pool.run_one() )
+        {
+            pool.sleep_until( [this]() { return count.load() == 0; } );
+        }
+    }
+    if ( error )
+    {
+        std::rethrow_exception( error );
+    }
+}
+
+
+
+/* intro_sort whose larger side of each big partition goes to the pool */
+template<typename Iterator, typename Compare>
+void parallel_intro_sort( Iterator first, Iterator last, Compare comp, int depth_limit, SortTaskGroup& group )
+{
+    while ( last - first + 1 >= PARALLEL_SORT_THRESHOLD )
+    {
+        Iterator pivot;
+        if ( !intro_partition( first, last, comp, depth_limit, pivot ) )
+        {
+            return;
+        }
+        Iterator task_first = pivot + 1;
+        Iterator task_last = last;
+        if ( pivot - first + 1 < last - pivot )
+        {
+            last = pivot;
+        }
+        else
+        {
+            task_first = first;
+            task_last = pivot;
+            first = pivot + 1;
+        }
+        group.run( [task_first, task_last, comp, depth_limit, &group]()
+        {
+            parallel_intro_sort( task_first, task_last, comp, depth_limit, group );
+        } );
+    }
+    intro_sort( first, last, comp, depth_limit );
+}
+
+
+/* hybrid_sort of first..last (inclusive) using all cores */
+template<typename Iterator, typename Compare>
+void parallel_hybrid_sort( Iterator first, Iterator last, Compare comp )
+{
+    if ( last - first + 1 < PARALLEL_SORT_THRESHOLD || SortPool::instance().worker_count() == 0 )
+    {
+        hybrid_sort( first, last, comp );
+        return;
+    }
+    if ( sort_run( first, last, comp ) )
+    {
+        return;
+    }
+    if constexpr ( uses_radix_sort<Iterator, Compare>() )
+    {
+        radix_sort( first, last );
+        return;
+    }
+    SortTaskGroup group;
+    try
+    {
+        parallel_intro_sort( first, last, comp, intro_depth_limit( last - first + 1 ), group );
+    }
+    catch ( ... )
+    {
+        /* the tasks already given out refer to group */
+        try
+        {
+            group.wait();
+        }
+        catch ( ... )
+        {}
+        throw;
+    }
+    group.wait();
+}
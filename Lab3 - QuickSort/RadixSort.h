@@ -0,0 +1,182 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <memory>
+#include <type_traits>
+#include <utility>
+
+/* radix sorts of integers and IEEE floats in ascending order (as std::less),
+   first and last point to the first and to the last element like in Sort.h */
+
+constexpr std::ptrdiff_t RADIX_MSD_CUTOFF = 64;
+
+
+template<typename T>
+constexpr bool is_radix_sortable = std::is_integral<T>::value ||
+    ( ( std::is_same<T, float>::value || std::is_same<T, double>::value ) && std::numeric_limits<T>::is_iec559 );
+
+template<std::size_t Size> struct RadixKey;
+template<> struct RadixKey<1> { using type = std::uint8_t; };
+template<> struct RadixKey<2> { using type = std::uint16_t; };
+template<> struct RadixKey<4> { using type = std::uint32_t; };
+template<> struct RadixKey<8> { using type = std::uint64_t; };
+
+template<typename T>
+using radix_key_t = typename RadixKey<sizeof( T )>::type;
+
+
+// unsigned key ordered as value: the sign bit of signed integers is flipped,
+// negative floats have all bits flipped and positive ones the sign bit
+template<typename T>
+radix_key_t<T> radix_key( T value )
+{
+    using Key = radix_key_t<T>;
+    const Key sign = (Key) ( (Key) 1 << ( sizeof( T ) * 8 - 1 ) );
+    if constexpr ( std::is_floating_point<T>::value )
+    {
+        Key bits;
+        std::memcpy( &bits, &value, sizeof( bits ) );
+        return ( bits & sign ) ? (Key) ~bits : (Key) ( bits | sign );
+    }
+    else if constexpr ( std::is_signed<T>::value )
+    {
+        return (Key) ( (Key) value ^ sign );
+    }
+    else
+    {
+        return (Key) value;
+    }
+}
+
+
+// least significant digit first, 11-bit digits for 32- and 64-bit keys
+// (8-bit for shorter ones); all digit histograms are counted in one pass
+// and digits equal in every element are skipped
+template<typename T>
+void lsd_radix_sort( T* first, T* last )
+{
+    static_assert( is_radix_sortable<T>, "radix sort needs integer or IEEE float elements" );
+    constexpr int BITS = sizeof( T ) >= 4 ? 11 : 8;
+    constexpr int DIGITS = ( (int) sizeof( T ) * 8 + BITS - 1 ) / BITS;
+    constexpr std::size_t BUCKETS = (std::size_t) 1 << BITS;
+    constexpr std::size_t MASK = BUCKETS - 1;
+
+    std::ptrdiff_t n = last - first + 1;
+    if ( n < 2 )
+        return;
+    std::unique_ptr<std::size_t[]> counts( new std::size_t[DIGITS * BUCKETS]() );
+    for ( T* p = first; p <= last; p++ )
+    {
+        radix_key_t<T> key = radix_key( *p );
+        for ( int d = 0; d < DIGITS; d++ )
+            counts[d * BUCKETS + ( ( key >> ( d * BITS ) ) & MASK )]++;
+    }
+
+    std::unique_ptr<T[]> buffer( new T[n] );
+    T* from = first;
+    T* to = buffer.get();
+    for ( int d = 0; d < DIGITS; d++ )
+    {
+        std::size_t* offsets = &counts[d * BUCKETS];
+        if ( offsets[( radix_key( *first ) >> ( d * BITS ) ) & MASK] == (std::size_t) n )
+            continue;
+        std::size_t sum = 0;
+        for ( std::size_t b = 0; b < BUCKETS; b++ )
+        {
+            std::size_t count = offsets[b];
+            offsets[b] = sum;
+            sum += count;
+        }
+        for ( std::ptrdiff_t i = 0; i < n; i++ )
+            to[offsets[( radix_key( from[i] ) >> ( d * BITS ) ) & MASK]++] = from[i];
+        std::swap( from, to );
+    }
+    if ( from != first )
+        std::memcpy( first, from, n * sizeof( T ) );
+}
+
+
+// most significant 8-bit digit first, in place (American flag sort):
+// elements are swapped into their buckets, then every bucket is sorted
+// by the next digit; buckets under RADIX_MSD_CUTOFF by insertion sort
+template<typename T>
+void msd_radix_sort( T* first, T* last, int shift = (int) sizeof( T ) * 8 - 8 )
+{
+    static_assert( is_radix_sortable<T>, "radix sort needs integer or IEEE float elements" );
+    std::ptrdiff_t n = last - first + 1;
+    if ( n < 2 )
+        return;
+    if ( n < RADIX_MSD_CUTOFF )
+    {
+        for ( T* i = first + 1; i <= last; i++ )
+        {
+            T current = *i;
+            radix_key_t<T> key = radix_key( current );
+            T* j = i;
+            for ( ; j > first && key < radix_key( *( j - 1 ) ); j-- )
+                *j = *( j - 1 );
+            *j = current;
+        }
+        return;
+    }
+
+    auto digit = [shift]( T value ) { return (std::size_t) ( radix_key( value ) >> shift ) & 0xFF; };
+    std::ptrdiff_t counts[256] = {};
+    for ( T* p = first; p <= last; p++ )
+        counts[digit( *p )]++;
+    if ( counts[digit( *first )] == n )
+    {
+        if ( shift > 0 )
+            msd_radix_sort( first, last, shift - 8 );
+        return;
+    }
+
+    std::ptrdiff_t heads[256];
+    std::ptrdiff_t ends[256];
+    std::ptrdiff_t sum = 0;
+    for ( int b = 0; b < 256; b++ )
+    {
+        heads[b] = sum;
+        sum += counts[b];
+        ends[b] = sum;
+    }
+    for ( int b = 0; b < 256; b++ )
+    {
+        while ( heads[b] < ends[b] )
+        {
+            T value = first[heads[b]];
+            std::size_t d = digit( value );
+            while ( d != (std::size_t) b )
+            {
+                std::swap( value, first[heads[d]++] );
+                d = digit( value );
+            }
+            first[heads[b]++] = value;
+        }
+    }
+
+    if ( shift == 0 )
+        return;
+    std::ptrdiff_t begin = 0;
+    for ( int b = 0; b < 256; b++ )
+    {
+        if ( counts[b] > 1 )
+            msd_radix_sort( first + begin, first + begin + counts[b] - 1, shift - 8 );
+        begin += counts[b];
+    }
+}
+
+
+// LSD for keys up to 32 bits; 64-bit keys take 6 LSD passes over the whole
+// array, while MSD mostly stops after the first digits
+template<typename T>
+void radix_sort( T* first, T* last )
+{
+    if constexpr ( sizeof( T ) <= 4 )
+        lsd_radix_sort( first, last );
+    else
+        msd_radix_sort( first, last );
+}
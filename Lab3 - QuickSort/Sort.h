@@ -1,59 +1,75 @@
 #pragma once
 
+#include <cstddef>
+#include <functional>
+#include <iterator>
+#include <type_traits>
+#include <utility>
 
-template<typename T, typename Compare>
-void insertion_sort( T* first, T* last, Compare comp )
+#include "RadixSort.h"
+#include "SortNetwork.h"
+
+/* the sorts take random access iterators (pointers, Array views,
+   std::reverse_iterator) to the first and to the last element */
+
+template<typename Iterator, typename Compare>
+void insertion_sort( Iterator first, Iterator last, Compare comp )
 {
-    for ( T* i = first; i <= last; i++ )
+    using T = typename std::iterator_traits<Iterator>::value_type;
+
+    for ( Iterator i = first; i <= last; i++ )
     {
         T current = std::move( *i );
-        T* j = i - 1;
-        while ( j >= first && comp( current, *j ) )
+        Iterator j = i;
+        while ( j > first && comp( current, *( j - 1 ) ) )
         {
-            *( j + 1 ) = std::move( *j );
+            *j = std::move( *( j - 1 ) );
             j--;
         }
-        *( j + 1 ) = std::move( current );
+        *j = std::move( current );
     }
 }
 
 
-template<typename T>
-void swap( T* a, T* b ) {
-    T tmp = std::move( *a );
+// not named swap: ADL would also find std::swap for iterators from std
+template<typename Iterator>
+void swap_values( Iterator a, Iterator b ) {
+    typename std::iterator_traits<Iterator>::value_type tmp = std::move( *a );
     *a = std::move( *b );
     *b = std::move( tmp );
 }
 
 // choose median value, simultaneously sorting
-template<typename T, typename Compare>
-T median( T* first, T* last, Compare comp )
+template<typename Iterator, typename Compare>
+typename std::iterator_traits<Iterator>::value_type median( Iterator first, Iterator last, Compare comp )
 {
-    T* middle = first + ( last - first ) / 2;
+    Iterator middle = first + ( last - first ) / 2;
     if ( comp( *last, *first ) )
     {
-        swap( first, last );
+        swap_values( first, last );
     }
     if ( comp( *middle, *first ) )
     {
-        swap( first, middle );
+        swap_values( first, middle );
     }
     if ( comp( *last, *middle ) )
     {
-        swap( middle, last );
+        swap_values( middle, last );
     }
     return *middle;
 }
 
 
-// Hoare partition, returns pivot pointer
-template<typename T, typename Compare>
-T* partition( T* first, T* last, Compare comp )
+// Hoare partition, returns pivot iterator;
+// no_swaps tells whether the interval was already partitioned
+template<typename Iterator, typename Compare>
+Iterator hoare_partition( Iterator first, Iterator last, Compare comp, bool& no_swaps )
 {
-    T pivot_value = median( first, last, comp );
+    typename std::iterator_traits<Iterator>::value_type pivot_value = median( first, last, comp );
     // first and last already compared to pivot
-    T* l = first + 1; 
-    T* r = last - 1;
+    Iterator l = first + 1; 
+    Iterator r = last - 1;
+    no_swaps = true;
     if ( l < r )
         while( true )
         {
@@ -63,17 +79,25 @@ T* partition( T* first, T* last, Compare comp )
                 r--;
             if ( l >= r )
                 break;
-            swap( l++, r-- );
+            swap_values( l++, r-- );
+            no_swaps = false;
         }
     return r;
 }
 
-template<typename T, typename Compare>
-void quick_sort( T* first, T* last, Compare comp )
+template<typename Iterator, typename Compare>
+Iterator hoare_partition( Iterator first, Iterator last, Compare comp )
+{
+    bool no_swaps;
+    return hoare_partition( first, last, comp, no_swaps );
+}
+
+template<typename Iterator, typename Compare>
+void quick_sort( Iterator first, Iterator last, Compare comp )
 {
     while ( last > first )
     {
-        T* pivot = partition( first, last, comp );
+        Iterator pivot = hoare_partition( first, last, comp );
         if ( pivot - first + 1 < last - pivot )
         {
             quick_sort( first, pivot, comp );
@@ -89,26 +113,231 @@ void quick_sort( T* first, T* last, Compare comp )
 }
 
 
-/* optimized quick sort */
+// moving *( first + index ) down the heap of first..first + size - 1
+template<typename Iterator, typename Compare>
+void sift_down( Iterator first, std::ptrdiff_t index, std::ptrdiff_t size, Compare comp )
+{
+    typename std::iterator_traits<Iterator>::value_type current = std::move( first[index] );
+    while ( 2 * index + 1 < size )
+    {
+        std::ptrdiff_t child = 2 * index + 1;
+        if ( child + 1 < size && comp( first[child], first[child + 1] ) )
+            child++;
+        if ( !comp( current, first[child] ) )
+            break;
+        first[index] = std::move( first[child] );
+        index = child;
+    }
+    first[index] = std::move( current );
+}
+
+// in-place, O(n log n) for any input
+template<typename Iterator, typename Compare>
+void heap_sort( Iterator first, Iterator last, Compare comp )
+{
+    std::ptrdiff_t size = last - first + 1;
+    for ( std::ptrdiff_t i = size / 2; i > 0; i-- )
+        sift_down( first, i - 1, size, comp );
+    for ( std::ptrdiff_t end = size - 1; end > 0; end-- )
+    {
+        swap_values( first, first + end );
+        sift_down( first, 0, end, comp );
+    }
+}
+
+
+/* optimized quick sort: introsort with pattern-defeating adaptivity */
 
 constexpr int INSERTION_SORT_USING_POINT = 8;
+constexpr int PARTIAL_INSERTION_SORT_LIMIT = 8;
+constexpr int NETWORK_SORT_USING_POINT = NETWORK_SORT_LENGTH;
+
+template<typename T, typename Compare>
+constexpr bool is_std_less = std::is_same<Compare, std::less<T>>::value || std::is_same<Compare, std::less<>>::value;
 
 template<typename T, typename Compare>
-void hybrid_sort( T* first, T* last, Compare comp )
+constexpr bool is_std_greater = std::is_same<Compare, std::greater<T>>::value || std::is_same<Compare, std::greater<>>::value;
+
+// pointers to int32, uint32 or float sorted by std::less or std::greater
+template<typename Iterator, typename Compare>
+constexpr bool uses_network_sort()
+{
+    if constexpr ( std::is_pointer<Iterator>::value )
+    {
+        using T = std::remove_pointer_t<Iterator>;
+        return !std::is_const<T>::value && is_network_sortable<T> && ( is_std_less<T, Compare> || is_std_greater<T, Compare> );
+    }
+    return false;
+}
+
+// intervals this short are not partitioned any more
+template<typename Iterator, typename Compare>
+constexpr std::ptrdiff_t leaf_length()
+{
+    return uses_network_sort<Iterator, Compare>() ? NETWORK_SORT_USING_POINT : INSERTION_SORT_USING_POINT;
+}
+
+template<typename Iterator, typename Compare>
+void leaf_sort( Iterator first, Iterator last, Compare comp )
+{
+    if constexpr ( uses_network_sort<Iterator, Compare>() )
+        network_sort( first, last, is_std_greater<std::remove_pointer_t<Iterator>, Compare> );
+    else
+        insertion_sort( first, last, comp );
+}
+
+// insertion sort giving up after PARTIAL_INSERTION_SORT_LIMIT element moves,
+// returns whether the interval is sorted
+template<typename Iterator, typename Compare>
+bool partial_insertion_sort( Iterator first, Iterator last, Compare comp )
 {
-    while ( last - first >= INSERTION_SORT_USING_POINT )
+    if ( last <= first )
+        return true;
+    std::ptrdiff_t moves = 0;
+    for ( Iterator i = first + 1; i <= last; i++ )
     {
-        T* pivot = partition( first, last, comp );
+        if ( !comp( *i, *( i - 1 ) ) )
+            continue;
+        typename std::iterator_traits<Iterator>::value_type current = std::move( *i );
+        Iterator j = i;
+        do
+        {
+            *j = std::move( *( j - 1 ) );
+            j--;
+        }
+        while ( j > first && comp( current, *( j - 1 ) ) );
+        *j = std::move( current );
+        moves += i - j;
+        if ( moves > PARTIAL_INSERTION_SORT_LIMIT )
+            return false;
+    }
+    return true;
+}
+
+// moving other elements to the places median() takes its candidates from,
+// so that an input pattern that gave a bad pivot does not repeat
+template<typename Iterator>
+void break_patterns( Iterator first, Iterator last )
+{
+    std::ptrdiff_t quarter = ( last - first + 1 ) / 4;
+    if ( quarter < 2 )
+        return;
+    Iterator middle = first + ( last - first ) / 2;
+    swap_values( first, first + quarter );
+    swap_values( middle, middle - quarter / 2 );
+    swap_values( last, last - quarter );
+}
+
+// whole interval already ascending or strictly descending (then reversed)
+template<typename Iterator, typename Compare>
+bool sort_run( Iterator first, Iterator last, Compare comp )
+{
+    if ( last <= first )
+        return true;
+    Iterator i = first;
+    if ( comp( *( first + 1 ), *first ) )
+    {
+        while ( i < last && comp( *( i + 1 ), *i ) )
+            i++;
+        if ( i < last )
+            return false;
+        for ( Iterator l = first, r = last; l < r; l++, r-- )
+            swap_values( l, r );
+        return true;
+    }
+    while ( i < last && !comp( *( i + 1 ), *i ) )
+        i++;
+    return i == last;
+}
+
+// one level of intro_sort: false if first..last got sorted right here
+// (heap sort once depth_limit is used up, or nearly sorted input),
+// otherwise pivot splits it
+template<typename Iterator, typename Compare>
+bool intro_partition( Iterator first, Iterator last, Compare comp, int& depth_limit, Iterator& pivot )
+{
+    if ( depth_limit == 0 )
+    {
+        heap_sort( first, last, comp );
+        return false;
+    }
+    depth_limit--;
+    bool no_swaps;
+    pivot = hoare_partition( first, last, comp, no_swaps );
+    std::ptrdiff_t eighth = ( last - first + 1 ) / 8;
+    if ( pivot - first + 1 < eighth || last - pivot < eighth )
+    {
+        break_patterns( first, pivot );
+        break_patterns( pivot + 1, last );
+    }
+    else if ( no_swaps && partial_insertion_sort( first, pivot, comp ) && partial_insertion_sort( pivot + 1, last, comp ) )
+    {
+        // nearly sorted input
+        return false;
+    }
+    return true;
+}
+
+template<typename Iterator, typename Compare>
+void intro_sort( Iterator first, Iterator last, Compare comp, int depth_limit )
+{
+    while ( last - first >= leaf_length<Iterator, Compare>() )
+    {
+        Iterator pivot;
+        if ( !intro_partition( first, last, comp, depth_limit, pivot ) )
+            return;
         if ( pivot - first + 1 < last - pivot )
         {
-            quick_sort( first, pivot, comp );
+            intro_sort( first, pivot, comp, depth_limit );
             first = pivot + 1;
         }
         else
         {
-            quick_sort( pivot + 1, last, comp );
+            intro_sort( pivot + 1, last, comp, depth_limit );
             last = pivot;
         }
     }
-    insertion_sort( first, last, comp );
-}
\ No newline at end of file
+    leaf_sort( first, last, comp );
+}
+
+// 2 * log2( n )
+inline int intro_depth_limit( std::ptrdiff_t n )
+{
+    int depth_limit = 0;
+    for ( ; n > 1; n /= 2 )
+        depth_limit += 2;
+    return depth_limit;
+}
+
+constexpr std::ptrdiff_t RADIX_SORT_THRESHOLD = 1024;
+
+// pointers to integers or IEEE floats sorted by std::less
+template<typename Iterator, typename Compare>
+constexpr bool uses_radix_sort()
+{
+    if constexpr ( std::is_pointer<Iterator>::value )
+    {
+        using T = std::remove_pointer_t<Iterator>;
+        return !std::is_const<T>::value && is_radix_sortable<T> && is_std_less<T, Compare>;
+    }
+    return false;
+}
+
+// depth budget 2 * log2( n ) keeps the worst case O(n log n),
+// sorted and reversed input take one pass,
+// long arrays of numbers compared by std::less go to radix_sort
+template<typename Iterator, typename Compare>
+void hybrid_sort( Iterator first, Iterator last, Compare comp )
+{
+    if ( sort_run( first, last, comp ) )
+        return;
+    if constexpr ( uses_radix_sort<Iterator, Compare>() )
+    {
+        if ( last - first + 1 >= RADIX_SORT_THRESHOLD )
+        {
+            radix_sort( first, last );
+            return;
+        }
+    }
+    intro_sort( first, last, comp, intro_depth_limit( last - first + 1 ) );
+}
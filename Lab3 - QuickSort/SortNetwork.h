@@ -0,0 +1,332 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#if defined( __x86_64__ ) || defined( __i386__ ) || defined( _M_X64 ) || defined( _M_IX86 )
+#define SORT_NETWORK_X86
+#include <immintrin.h>
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+#endif
+
+#if defined( __GNUC__ ) || defined( __clang__ )
+#define SORT_NETWORK_TARGET( isa ) __attribute__( ( target( isa ) ) )
+// everything the kernel calls is inlined and compiled for its instruction set
+#define SORT_NETWORK_KERNEL( isa ) __attribute__( ( target( isa ), flatten ) )
+#else
+// MSVC compiles intrinsics of any instruction set as they are
+#define SORT_NETWORK_TARGET( isa )
+#define SORT_NETWORK_KERNEL( isa )
+#endif
+
+/* sorting networks for leaves of hybrid_sort over int32, uint32 and float:
+   bitonic networks of 8, 16 or 32 keys in AVX2 or SSE4.1 registers,
+   the instruction set is chosen once by CPUID; other processors run the
+   same network in scalar code. A network does the same min/max steps for
+   any input, so unlike insertion sort it has no branches to mispredict */
+
+constexpr int NETWORK_SORT_LENGTH = 32;
+
+
+template<typename T>
+constexpr bool is_network_sortable = std::is_same<T, std::int32_t>::value || std::is_same<T, std::uint32_t>::value ||
+    ( std::is_same<T, float>::value && std::numeric_limits<float>::is_iec559 );
+
+
+// signed key ordered as value; -0.0f and 0.0f get different keys,
+// so the sorted floats keep their bits
+template<typename T>
+std::int32_t to_network_key( T value )
+{
+    if constexpr ( std::is_same<T, float>::value )
+    {
+        std::int32_t bits;
+        std::memcpy( &bits, &value, sizeof( bits ) );
+        return bits ^ ( ( bits >> 31 ) & 0x7FFFFFFF );
+    }
+    else if constexpr ( std::is_unsigned<T>::value )
+    {
+        return (std::int32_t) ( value ^ 0x80000000u );
+    }
+    else
+    {
+        return value;
+    }
+}
+
+template<typename T>
+T from_network_key( std::int32_t key )
+{
+    if constexpr ( std::is_same<T, float>::value )
+    {
+        std::int32_t bits = key ^ ( ( key >> 31 ) & 0x7FFFFFFF );
+        T value;
+        std::memcpy( &value, &bits, sizeof( value ) );
+        return value;
+    }
+    else if constexpr ( std::is_unsigned<T>::value )
+    {
+        return (T) key ^ 0x80000000u;
+    }
+    else
+    {
+        return key;
+    }
+}
+
+
+// the network templates pass vectors by value without a target of their
+// own, but they only run inlined into the kernels
+#if defined( __GNUC__ ) && !defined( __clang__ )
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wpsabi"
+#endif
+
+// all bits set if element i of pair ( i, i ^ j ) takes the maximum:
+// blocks of k elements are sorted ascending and descending in turn
+constexpr std::int32_t takes_max( int i, int j, int k )
+{
+    return ( ( i & j ) != 0 ) != ( ( i & k ) != 0 ) ? -1 : 0;
+}
+
+// vector R of the network step comparing pairs ( i, i ^ J ) in blocks of K:
+// pairs a vector or more apart are compared vector by vector,
+// closer ones inside the vector against its lanes swapped
+template<typename Ops, int K, int J, int R>
+inline void bitonic_compare( typename Ops::Vector* v )
+{
+    using Vector = typename Ops::Vector;
+    constexpr int LANES = Ops::LANES;
+    if constexpr ( J >= LANES )
+    {
+        constexpr int partner = R ^ ( J / LANES );
+        if constexpr ( partner > R )
+        {
+            Vector low = Ops::min( v[R], v[partner] );
+            Vector high = Ops::max( v[R], v[partner] );
+            constexpr bool descending = ( R * LANES & K ) != 0;
+            v[R] = descending ? high : low;
+            v[partner] = descending ? low : high;
+        }
+    }
+    else
+    {
+        Vector swapped = Ops::template swap_lanes<J>( v[R] );
+        v[R] = Ops::blend( Ops::min( v[R], swapped ), Ops::max( v[R], swapped ), Ops::template upper_lanes<R * LANES, J, K>() );
+    }
+}
+
+template<typename Ops, int K, int J, int... R>
+inline void bitonic_step( typename Ops::Vector* v, std::integer_sequence<int, R...> )
+{
+    ( bitonic_compare<Ops, K, J, R>( v ), ... );
+}
+
+// bitonic network over SIZE keys held in SIZE / Ops::LANES vectors,
+// unrolled at compile time
+template<typename Ops, int SIZE, int K = 2, int J = 1>
+inline void bitonic_network( typename Ops::Vector* v )
+{
+    bitonic_step<Ops, K, J>( v, std::make_integer_sequence<int, SIZE / Ops::LANES>() );
+    if constexpr ( J > 1 )
+        bitonic_network<Ops, SIZE, K, J / 2>( v );
+    else if constexpr ( K < SIZE )
+        bitonic_network<Ops, SIZE, 2 * K, K>( v );
+}
+
+
+struct ScalarNetwork
+{
+    using Vector = std::int32_t;
+    static constexpr int LANES = 1;
+
+    static Vector min( Vector a, Vector b ) { return a < b ? a : b; }
+    static Vector max( Vector a, Vector b ) { return a < b ? b : a; }
+};
+
+// size is 8, 16 or 32
+inline void scalar_network_sort( std::int32_t* keys, int size )
+{
+    if ( size == 8 )
+        bitonic_network<ScalarNetwork, 8>( keys );
+    else if ( size == 16 )
+        bitonic_network<ScalarNetwork, 16>( keys );
+    else
+        bitonic_network<ScalarNetwork, 32>( keys );
+}
+
+
+#ifdef SORT_NETWORK_X86
+
+struct Sse41Network
+{
+    using Vector = __m128i;
+    static constexpr int LANES = 4;
+
+    SORT_NETWORK_TARGET( "sse4.1" ) static Vector load( const std::int32_t* p ) { return _mm_loadu_si128( (const __m128i*) p ); }
+    SORT_NETWORK_TARGET( "sse4.1" ) static void store( std::int32_t* p, Vector v ) { _mm_storeu_si128( (__m128i*) p, v ); }
+    SORT_NETWORK_TARGET( "sse4.1" ) static Vector min( Vector a, Vector b ) { return _mm_min_epi32( a, b ); }
+    SORT_NETWORK_TARGET( "sse4.1" ) static Vector max( Vector a, Vector b ) { return _mm_max_epi32( a, b ); }
+    SORT_NETWORK_TARGET( "sse4.1" ) static Vector blend( Vector a, Vector b, Vector mask ) { return _mm_blendv_epi8( a, b, mask ); }
+
+    // lane l gets lane l ^ J
+    template<int J>
+    SORT_NETWORK_TARGET( "sse4.1" ) static Vector swap_lanes( Vector v )
+    {
+        if constexpr ( J == 1 )
+            return _mm_shuffle_epi32( v, _MM_SHUFFLE( 2, 3, 0, 1 ) );
+        else
+            return _mm_shuffle_epi32( v, _MM_SHUFFLE( 1, 0, 3, 2 ) );
+    }
+
+    template<int FIRST, int J, int K>
+    SORT_NETWORK_TARGET( "sse4.1" ) static Vector upper_lanes()
+    {
+        return _mm_setr_epi32( takes_max( FIRST, J, K ), takes_max( FIRST + 1, J, K ), takes_max( FIRST + 2, J, K ), takes_max( FIRST + 3, J, K ) );
+    }
+};
+
+
+struct Avx2Network
+{
+    using Vector = __m256i;
+    static constexpr int LANES = 8;
+
+    SORT_NETWORK_TARGET( "avx2" ) static Vector load( const std::int32_t* p ) { return _mm256_loadu_si256( (const __m256i*) p ); }
+    SORT_NETWORK_TARGET( "avx2" ) static void store( std::int32_t* p, Vector v ) { _mm256_storeu_si256( (__m256i*) p, v ); }
+    SORT_NETWORK_TARGET( "avx2" ) static Vector min( Vector a, Vector b ) { return _mm256_min_epi32( a, b ); }
+    SORT_NETWORK_TARGET( "avx2" ) static Vector max( Vector a, Vector b ) { return _mm256_max_epi32( a, b ); }
+    SORT_NETWORK_TARGET( "avx2" ) static Vector blend( Vector a, Vector b, Vector mask ) { return _mm256_blendv_epi8( a, b, mask ); }
+
+    // lane l gets lane l ^ J
+    template<int J>
+    SORT_NETWORK_TARGET( "avx2" ) static Vector swap_lanes( Vector v )
+    {
+        if constexpr ( J == 1 )
+            return _mm256_shuffle_epi32( v, _MM_SHUFFLE( 2, 3, 0, 1 ) );
+        else if constexpr ( J == 2 )
+            return _mm256_shuffle_epi32( v, _MM_SHUFFLE( 1, 0, 3, 2 ) );
+        else
+            return _mm256_permute2x128_si256( v, v, 1 );
+    }
+
+    template<int FIRST, int J, int K>
+    SORT_NETWORK_TARGET( "avx2" ) static Vector upper_lanes()
+    {
+        return _mm256_setr_epi32( takes_max( FIRST, J, K ), takes_max( FIRST + 1, J, K ), takes_max( FIRST + 2, J, K ), takes_max( FIRST + 3, J, K ),
+            takes_max( FIRST + 4, J, K ), takes_max( FIRST + 5, J, K ), takes_max( FIRST + 6, J, K ), takes_max( FIRST + 7, J, K ) );
+    }
+};
+
+
+template<typename Ops, int SIZE>
+inline void vector_network_sort( std::int32_t* keys )
+{
+    typename Ops::Vector v[SIZE / Ops::LANES];
+    for ( int r = 0; r < SIZE / Ops::LANES; r++ )
+        v[r] = Ops::load( keys + r * Ops::LANES );
+    bitonic_network<Ops, SIZE>( v );
+    for ( int r = 0; r < SIZE / Ops::LANES; r++ )
+        Ops::store( keys + r * Ops::LANES, v[r] );
+}
+
+SORT_NETWORK_KERNEL( "sse4.1" ) inline void sse41_network_sort( std::int32_t* keys, int size )
+{
+    if ( size == 8 )
+        vector_network_sort<Sse41Network, 8>( keys );
+    else if ( size == 16 )
+        vector_network_sort<Sse41Network, 16>( keys );
+    else
+        vector_network_sort<Sse41Network, 32>( keys );
+}
+
+SORT_NETWORK_KERNEL( "avx2" ) inline void avx2_network_sort( std::int32_t* keys, int size )
+{
+    if ( size == 8 )
+        vector_network_sort<Avx2Network, 8>( keys );
+    else if ( size == 16 )
+        vector_network_sort<Avx2Network, 16>( keys );
+    else
+        vector_network_sort<Avx2Network, 32>( keys );
+}
+
+#endif
+
+#if defined( __GNUC__ ) && !defined( __clang__ )
+#pragma GCC diagnostic pop
+#endif
+
+
+using NetworkKernel = void ( * )( std::int32_t* keys, int size );
+
+// the kernels the processor (and the OS, for AVX registers) supports,
+// from the scalar fallback to the fastest one
+inline std::vector<NetworkKernel> supported_network_kernels()
+{
+    std::vector<NetworkKernel> kernels = { scalar_network_sort };
+#ifdef SORT_NETWORK_X86
+#if defined( _MSC_VER ) && !defined( __clang__ )
+    int info[4];
+    __cpuid( info, 0 );
+    int leaves = info[0];
+    __cpuid( info, 1 );
+    bool sse41 = ( info[2] & ( 1 << 19 ) ) != 0;
+    bool avx = ( info[2] & ( 1 << 27 ) ) != 0 && ( info[2] & ( 1 << 28 ) ) != 0 && ( _xgetbv( 0 ) & 6 ) == 6;
+    bool avx2 = false;
+    if ( avx && leaves >= 7 )
+    {
+        __cpuidex( info, 7, 0 );
+        avx2 = ( info[1] & ( 1 << 5 ) ) != 0;
+    }
+#else
+    __builtin_cpu_init();
+    bool sse41 = __builtin_cpu_supports( "sse4.1" );
+    bool avx2 = __builtin_cpu_supports( "avx2" );
+#endif
+    if ( sse41 )
+        kernels.push_back( sse41_network_sort );
+    if ( avx2 )
+        kernels.push_back( avx2_network_sort );
+#endif
+    return kernels;
+}
+
+// the best kernel for this processor
+inline NetworkKernel select_network_kernel()
+{
+    return supported_network_kernels().back();
+}
+
+inline NetworkKernel network_kernel()
+{
+    static const NetworkKernel kernel = select_network_kernel();
+    return kernel;
+}
+
+
+// sorting first..last of at most NETWORK_SORT_LENGTH elements,
+// padded with the greatest key up to a network size
+template<typename T>
+void network_sort( T* first, T* last, bool descending )
+{
+    static_assert( is_network_sortable<T>, "sorting networks take int32, uint32 or float elements" );
+    int n = (int) ( last - first + 1 );
+    if ( n < 2 )
+        return;
+    int size = n <= 8 ? 8 : n <= 16 ? 16 : 32;
+    std::int32_t keys[NETWORK_SORT_LENGTH];
+    for ( int i = 0; i < n; i++ )
+        keys[i] = to_network_key( first[i] );
+    for ( int i = n; i < size; i++ )
+        keys[i] = std::numeric_limits<std::int32_t>::max();
+    network_kernel()( keys, size );
+    for ( int i = 0; i < n; i++ )
+        first[i] = from_network_key<T>( keys[descending ? n - 1 - i : i] );
+}
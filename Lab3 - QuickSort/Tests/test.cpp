@@ -1,7 +1,16 @@
 #include "pch.h"
+#include <algorithm>
+#include <functional>
+#include <limits>
 #include <random>
+#include <stdexcept>
+#include <thread>
+#include <vector>
 
 #include "../Sort.h"
+#include "../ParallelSort.h"
+#include "../../Lab2 - Dynamic Array/Array.h"
+#include "../../Lab2 - Dynamic Array/View.h"
 
 constexpr int LENGTH = 5000;
 
@@ -255,4 +264,274 @@ TEST( HybridSortTest, Rational )
 	{
 		EXPECT_TRUE( a[i] <= a[i + 1] );
 	}
-}
\ No newline at end of file
+}
+
+
+TEST( HybridSortTest, Views )
+{
+	std::default_random_engine RandomEngine( time( 0 ) );
+	std::uniform_int_distribution<int> RandomIntGenerator( 1, 100 );
+
+	Array<int> a;
+	for ( int i = 0; i < LENGTH; i++ )
+	{
+		a.insert( RandomIntGenerator( RandomEngine ) );
+	}
+	Array<int> copy( a );
+
+	auto middle = slice( a, LENGTH / 4, LENGTH / 2 );
+	hybrid_sort( middle.begin(), middle.end() - 1, []( int a, int b ) {return a < b; } );
+	auto even = strided( a, 0, LENGTH, 2 );
+	hybrid_sort( even.begin(), even.end() - 1, []( int a, int b ) {return a < b; } );
+	for ( std::size_t i = 1; i < even.length(); i++ )
+	{
+		EXPECT_TRUE( even[i - 1] <= even[i] );
+	}
+
+	auto back = reversed( a );
+	hybrid_sort( back.begin() + LENGTH / 2, back.end() - 1, []( int a, int b ) {return a < b; } );
+	for ( int i = 1; i < LENGTH / 2; i++ )
+	{
+		EXPECT_TRUE( a[i - 1] >= a[i] );
+	}
+	EXPECT_TRUE( std::is_permutation( a.begin(), a.end(), copy.begin() ) );
+
+	hybrid_sort( a.rbegin(), a.rend() - 1, []( int a, int b ) {return a < b; } );
+	for ( int i = 0; i < LENGTH - 1; i++ )
+	{
+		EXPECT_TRUE( a[i] >= a[i + 1] );
+	}
+}
+
+
+TEST( HeapSortTest, Int )
+{
+	std::default_random_engine RandomEngine( time( 0 ) );
+	std::uniform_int_distribution<int> RandomIntGenerator( 1, 100 );
+
+	Array<int> a;
+	for ( int i = 0; i < LENGTH; i++ )
+	{
+		a.insert( RandomIntGenerator( RandomEngine ) );
+	}
+
+	heap_sort( a.begin(), a.end() - 1, []( int a, int b ) {return a < b; } );
+
+	for ( int i = 0; i < LENGTH - 1; i++ )
+	{
+		EXPECT_TRUE( a[i] <= a[i + 1] );
+	}
+}
+
+
+// McIlroy's adversary: values are fixed lazily so that every pivot turns out
+// bad, which makes plain quick sort quadratic on any pivot rule
+TEST( HybridSortTest, Adversary )
+{
+	auto comparisons = [] ( bool hybrid ) {
+		Array<int> values;
+		Array<int> a;
+		for ( int i = 0; i < LENGTH; i++ )
+		{
+			values.insert( LENGTH );
+			a.insert( i );
+		}
+		int solid = 0;
+		int candidate = 0;
+		long long count = 0;
+		auto comp = [&]( int x, int y ) {
+			count++;
+			if ( values[x] == LENGTH && values[y] == LENGTH )
+				values[x == candidate ? x : y] = solid++;
+			if ( values[x] == LENGTH )
+				candidate = x;
+			else if ( values[y] == LENGTH )
+				candidate = y;
+			return values[x] < values[y];
+		};
+		if ( hybrid )
+			hybrid_sort( a.begin(), a.end() - 1, comp );
+		else
+			quick_sort( a.begin(), a.end() - 1, comp );
+		for ( int i = 0; i < LENGTH - 1; i++ )
+		{
+			EXPECT_TRUE( values[a[i]] <= values[a[i + 1]] );
+		}
+		return count;
+	};
+
+	EXPECT_GT( comparisons( false ), (long long) LENGTH * LENGTH / 8 );
+	EXPECT_LT( comparisons( true ), (long long) LENGTH * 13 * 4 );
+}
+
+
+TEST( HybridSortTest, Patterns )
+{
+	std::default_random_engine RandomEngine( time( 0 ) );
+	std::uniform_int_distribution<int> RandomIndexGenerator( 0, LENGTH - 1 );
+
+	for ( int pattern = 0; pattern < 6; pattern++ )
+	{
+		Array<int> a;
+		for ( int i = 0; i < LENGTH; i++ )
+		{
+			switch ( pattern )
+			{
+				case 0: a.insert( i ); break;                                   // sorted
+				case 1: a.insert( LENGTH - i ); break;                          // reversed
+				case 2: a.insert( i < LENGTH / 2 ? i : LENGTH - i ); break;     // organ pipe
+				case 3: a.insert( i % 16 ); break;                              // sawtooth
+				case 4: a.insert( 7 ); break;                                   // equal
+				default: a.insert( i );                                         // nearly sorted
+			}
+		}
+		if ( pattern == 5 )
+			for ( int k = 0; k < 10; k++ )
+				std::swap( a[RandomIndexGenerator( RandomEngine )], a[RandomIndexGenerator( RandomEngine )] );
+
+		long long count = 0;
+		hybrid_sort( a.begin(), a.end() - 1, [&count]( int a, int b ) { count++; return a < b; } );
+		for ( int i = 0; i < LENGTH - 1; i++ )
+		{
+			EXPECT_TRUE( a[i] <= a[i + 1] );
+		}
+		if ( pattern < 2 || pattern == 4 )
+		{
+			EXPECT_LT( count, 2 * LENGTH );
+		}
+	}
+}
+
+
+TEST( ParallelSortTest, Int )
+{
+	std::default_random_engine RandomEngine( time( 0 ) );
+	std::uniform_int_distribution<int> RandomIntGenerator( 1, 1000000 );
+
+	const int length = 40 * PARALLEL_SORT_THRESHOLD;
+	std::vector<std::vector<int>> arrays( 4, std::vector<int>( length ) );
+	for ( auto& a : arrays )
+		for ( int& x : a )
+			x = RandomIntGenerator( RandomEngine );
+	std::vector<std::vector<int>> expected = arrays;
+	for ( auto& a : expected )
+		std::sort( a.begin(), a.end() );
+
+	// several callers at once share the pool
+	std::vector<std::thread> callers;
+	for ( auto& a : arrays )
+		callers.emplace_back( [&a]() { parallel_hybrid_sort( a.data(), a.data() + a.size() - 1, []( int a, int b ) {return a < b; } ); } );
+	for ( auto& caller : callers )
+		caller.join();
+	EXPECT_TRUE( arrays == expected );
+
+	std::vector<int> reversed( expected[0].rbegin(), expected[0].rend() );
+	parallel_hybrid_sort( reversed.data(), reversed.data() + length - 1, []( int a, int b ) {return a < b; } );
+	EXPECT_TRUE( reversed == expected[0] );
+
+	std::shuffle( reversed.begin(), reversed.end(), RandomEngine );
+	std::atomic<int> comparisons( 0 );
+	auto throwing = [&comparisons, length]( int a, int b ) {
+		if ( ++comparisons == 3 * length )
+			throw std::runtime_error( "comparison failed" );
+		return a < b;
+	};
+	EXPECT_THROW( parallel_hybrid_sort( reversed.data(), reversed.data() + length - 1, throwing ), std::runtime_error );
+
+	// dispatched to radix_sort; the throw may have lost or duplicated
+	// an element held aside by a shift, so the input is rebuilt
+	reversed = expected[0];
+	std::shuffle( reversed.begin(), reversed.end(), RandomEngine );
+	parallel_hybrid_sort( reversed.data(), reversed.data() + length - 1, std::less<int>() );
+	EXPECT_TRUE( reversed == expected[0] );
+}
+
+
+template<typename T, typename Generator>
+void check_radix_sort( int length, Generator generate )
+{
+	std::vector<T> a( length );
+	for ( T& x : a )
+		x = generate();
+	std::vector<T> expected = a;
+	std::sort( expected.begin(), expected.end() );
+
+	std::vector<T> lsd = a;
+	lsd_radix_sort( lsd.data(), lsd.data() + length - 1 );
+	EXPECT_TRUE( lsd == expected );
+	std::vector<T> msd = a;
+	msd_radix_sort( msd.data(), msd.data() + length - 1 );
+	EXPECT_TRUE( msd == expected );
+	// std::less on a pointer range is dispatched to radix_sort
+	hybrid_sort( a.data(), a.data() + length - 1, std::less<T>() );
+	EXPECT_TRUE( a == expected );
+}
+
+
+TEST( RadixSortTest, Numbers )
+{
+	std::default_random_engine RandomEngine( time( 0 ) );
+	std::uniform_int_distribution<long long> RandomIntGenerator( std::numeric_limits<long long>::min(), std::numeric_limits<long long>::max() );
+	std::uniform_real_distribution<double> RandomRealGenerator( -1e9, 1e9 );
+	const int length = 4 * RADIX_SORT_THRESHOLD;
+
+	check_radix_sort<int>( length, [&]() { return (int) RandomIntGenerator( RandomEngine ); } );
+	check_radix_sort<unsigned long long>( length, [&]() { return (unsigned long long) RandomIntGenerator( RandomEngine ); } );
+	check_radix_sort<signed char>( length, [&]() { return (signed char) RandomIntGenerator( RandomEngine ); } );
+	// few distinct values, equal high digits
+	check_radix_sort<long long>( length, [&]() { return RandomIntGenerator( RandomEngine ) % 100; } );
+	check_radix_sort<float>( length, [&]() { return (float) RandomRealGenerator( RandomEngine ); } );
+
+	const double specials[] = { -0.0, 0.0, std::numeric_limits<double>::infinity(), -std::numeric_limits<double>::infinity(),
+		std::numeric_limits<double>::denorm_min(), std::numeric_limits<double>::lowest() };
+	int i = 0;
+	check_radix_sort<double>( length, [&]() {
+		i++;
+		return i % 10 == 0 ? specials[i / 10 % 6] : RandomRealGenerator( RandomEngine );
+	} );
+}
+
+
+
+TEST( SortNetworkTest, Kernels )
+{
+	std::default_random_engine RandomEngine( time( 0 ) );
+	std::uniform_int_distribution<int> RandomIntGenerator( -20, 20 );
+
+	// every kernel this processor can run, the scalar fallback included
+	std::vector<NetworkKernel> kernels = supported_network_kernels();
+	EXPECT_EQ( kernels.back(), network_kernel() );
+	for ( NetworkKernel kernel : kernels )
+		for ( int size : { 8, 16, 32 } )
+			for ( int k = 0; k < 100; k++ )
+			{
+				std::int32_t keys[NETWORK_SORT_LENGTH];
+				for ( int i = 0; i < size; i++ )
+					keys[i] = RandomIntGenerator( RandomEngine );
+				std::vector<std::int32_t> expected( keys, keys + size );
+				std::sort( expected.begin(), expected.end() );
+				kernel( keys, size );
+				EXPECT_TRUE( std::equal( expected.begin(), expected.end(), keys ) );
+			}
+
+	for ( int length = 1; length <= 40; length++ )
+	{
+		std::vector<float> a( length );
+		std::vector<unsigned> b( length );
+		for ( int i = 0; i < length; i++ )
+		{
+			int x = RandomIntGenerator( RandomEngine );
+			a[i] = x == 0 ? -0.0f : x == 1 ? std::numeric_limits<float>::infinity() : x / 3.0f;
+			b[i] = (unsigned) x;
+		}
+		std::vector<float> expected_a = a;
+		std::sort( expected_a.begin(), expected_a.end(), std::greater<float>() );
+		std::vector<unsigned> expected_b = b;
+		std::sort( expected_b.begin(), expected_b.end() );
+
+		hybrid_sort( a.data(), a.data() + length - 1, std::greater<float>() );
+		EXPECT_TRUE( a == expected_a );
+		hybrid_sort( b.data(), b.data() + length - 1, std::less<>() );
+		EXPECT_TRUE( b == expected_b );
+	}
+}